@@ -2,55 +2,119 @@
 #include "Bitmap.h"
 
 #include <cstring>
+#include <algorithm>
 
 namespace msdfgen {
 
+static int greatestCommonDivisor(int a, int b) {
+    while (b) {
+        int r = a%b;
+        a = b, b = r;
+    }
+    return a;
+}
+
 template <typename T>
-Bitmap<T>::Bitmap() : content(NULL), w(0), h(0) { }
+Bitmap<T>::Bitmap() : storage(NULL), capacity(0), content(NULL), w(0), h(0), rowStride(0) { }
 
 template <typename T>
-Bitmap<T>::Bitmap(int width, int height) : w(width), h(height) {
-    content = new T[w*h];
+Bitmap<T>::Bitmap(int width, int height) : storage(NULL), capacity(0), content(NULL), w(0), h(0), rowStride(0) {
+    allocate(width, height);
 }
 
 template <typename T>
-Bitmap<T>::Bitmap(const Bitmap<T> &orig) : w(orig.w), h(orig.h) {
-    content = new T[w*h];
-    memcpy(content, orig.content, w*h*sizeof(T));
+Bitmap<T>::Bitmap(T *pixels, int width, int height, int stride) : storage(NULL), capacity(0), content(pixels), w(width), h(height), rowStride(stride) { }
+
+template <typename T>
+Bitmap<T>::Bitmap(const Bitmap<T> &orig) : storage(NULL), capacity(0), content(NULL), w(0), h(0), rowStride(0) {
+    allocate(orig.w, orig.h);
+    for (int y = 0; y < h; ++y)
+        memcpy(row(y), orig.row(y), w*sizeof(T));
 }
 
 #ifdef MSDFGEN_USE_CPP11
 template <typename T>
-Bitmap<T>::Bitmap(Bitmap<T> &&orig) : content(orig.content), w(orig.w), h(orig.h) {
+Bitmap<T>::Bitmap(Bitmap<T> &&orig) : storage(orig.storage), capacity(orig.capacity), content(orig.content), w(orig.w), h(orig.h), rowStride(orig.rowStride) {
+    orig.storage = NULL;
+    orig.capacity = 0;
     orig.content = NULL;
 }
 #endif
 
 template <typename T>
 Bitmap<T>::~Bitmap() {
-    delete [] content;
+    delete [] storage;
 }
 
 template <typename T>
 Bitmap<T> & Bitmap<T>::operator=(const Bitmap<T> &orig) {
-    delete [] content;
-    w = orig.w, h = orig.h;
-    content = new T[w*h];
-    memcpy(content, orig.content, w*h*sizeof(T));
+    if (this != &orig) {
+        allocate(orig.w, orig.h);
+        for (int y = 0; y < h; ++y)
+            memcpy(row(y), orig.row(y), w*sizeof(T));
+    }
     return *this;
 }
 
 #ifdef MSDFGEN_USE_CPP11
 template <typename T>
 Bitmap<T> & Bitmap<T>::operator=(Bitmap<T> &&orig) {
-    delete [] content;
-    content = orig.content;
-    w = orig.w, h = orig.h;
-    orig.content = NULL;
+    if (this != &orig) {
+        delete [] storage;
+        storage = orig.storage;
+        capacity = orig.capacity;
+        content = orig.content;
+        w = orig.w, h = orig.h;
+        rowStride = orig.rowStride;
+        orig.storage = NULL;
+        orig.capacity = 0;
+        orig.content = NULL;
+    }
     return *this;
 }
 #endif
 
+template <typename T>
+int Bitmap<T>::strideOf(int width) {
+    // The stride is the width rounded up to a multiple of the number of pixels that spans a whole number of alignment units
+    int rowAlignment = MSDFGEN_BITMAP_ALIGNMENT/greatestCommonDivisor(MSDFGEN_BITMAP_ALIGNMENT, sizeof(T));
+    return (width+rowAlignment-1)/rowAlignment*rowAlignment;
+}
+
+/// Sets the dimensions and the row stride, and allocates the storage unless the current one is large enough.
+template <typename T>
+void Bitmap<T>::allocate(int width, int height) {
+    w = width, h = height;
+    rowStride = strideOf(width);
+    size_t size = (size_t) rowStride*height*sizeof(T);
+    if (size > capacity) {
+        delete [] storage;
+        storage = new char[size+MSDFGEN_BITMAP_ALIGNMENT-1];
+        capacity = size;
+    }
+    if (!storage) {
+        content = NULL;
+        return;
+    }
+    size_t misalignment = (size_t) storage%MSDFGEN_BITMAP_ALIGNMENT;
+    content = reinterpret_cast<T *>(storage+(misalignment ? MSDFGEN_BITMAP_ALIGNMENT-misalignment : 0));
+}
+
+template <typename T>
+void Bitmap<T>::resize(int width, int height) {
+    allocate(width, height);
+}
+
+template <typename T>
+void Bitmap<T>::swap(Bitmap<T> &other) {
+    std::swap(storage, other.storage);
+    std::swap(capacity, other.capacity);
+    std::swap(content, other.content);
+    std::swap(w, other.w);
+    std::swap(h, other.h);
+    std::swap(rowStride, other.rowStride);
+}
+
 template <typename T>
 int Bitmap<T>::width() const {
     return w;
@@ -61,17 +125,39 @@ int Bitmap<T>::height() const {
     return h;
 }
 
+template <typename T>
+int Bitmap<T>::stride() const {
+    return rowStride;
+}
+
 template <typename T>
 T & Bitmap<T>::operator()(int x, int y) {
-    return content[y*w+x];
+    return content[(ptrdiff_t) rowStride*y+x];
 }
 
 template <typename T>
 const T & Bitmap<T>::operator()(int x, int y) const {
-    return content[y*w+x];
+    return content[(ptrdiff_t) rowStride*y+x];
+}
+
+template <typename T>
+T * Bitmap<T>::row(int y) {
+    return content+(ptrdiff_t) rowStride*y;
+}
+
+template <typename T>
+const T * Bitmap<T>::row(int y) const {
+    return content+(ptrdiff_t) rowStride*y;
 }
 
 template class Bitmap<float>;
 template class Bitmap<FloatRGB>;
+template class Bitmap<FloatRGBA>;
+template class Bitmap<unsigned char>;
+template class Bitmap<ByteRGB>;
+template class Bitmap<ByteRGBA>;
+template class Bitmap<Half>;
+template class Bitmap<HalfRGB>;
+template class Bitmap<HalfRGBA>;
 
 }
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace msdfgen {
 
 /// A floating-point RGB pixel.
@@ -8,13 +10,51 @@ struct FloatRGB {
     float r, g, b;
 };
 
-/// A 2D image bitmap.
+/// A floating-point RGBA pixel.
+struct FloatRGBA {
+    float r, g, b, a;
+};
+
+/// An 8-bit RGB pixel. Single-channel 8-bit bitmaps use unsigned char.
+struct ByteRGB {
+    unsigned char r, g, b;
+};
+
+/// An 8-bit RGBA pixel.
+struct ByteRGBA {
+    unsigned char r, g, b, a;
+};
+
+/// A half-precision (IEEE 754 binary16) floating-point value, stored as its bits. See pixel-conversion.hpp.
+struct Half {
+    unsigned short bits;
+};
+
+/// A half-precision floating-point RGB pixel.
+struct HalfRGB {
+    Half r, g, b;
+};
+
+/// A half-precision floating-point RGBA pixel.
+struct HalfRGBA {
+    Half r, g, b, a;
+};
+
+// Alignment in bytes of the rows of bitmaps that allocate their own storage.
+#define MSDFGEN_BITMAP_ALIGNMENT 64
+
+/** A 2D image bitmap. Unless it wraps memory provided by the caller, each row starts at an address aligned
+ *  to MSDFGEN_BITMAP_ALIGNMENT bytes and consecutive rows are stride() pixels apart, which may exceed the width.
+ */
 template <typename T>
 class Bitmap {
 
 public:
     Bitmap();
     Bitmap(int width, int height);
+    /// Wraps the caller's memory, in which consecutive rows are stride pixels apart, without copying it.
+    /// The memory must outlive the bitmap and is not freed by it. Copies of the bitmap allocate their own storage.
+    Bitmap(T *pixels, int width, int height, int stride);
     Bitmap(const Bitmap<T> &orig);
 #ifdef MSDFGEN_USE_CPP11
     Bitmap(Bitmap<T> &&orig);
@@ -24,16 +64,32 @@ public:
 #ifdef MSDFGEN_USE_CPP11
     Bitmap<T> & operator=(Bitmap<T> &&orig);
 #endif
+    /// Changes the dimensions of the bitmap, reusing its storage if it is owned and large enough. The contents become undefined.
+    void resize(int width, int height);
+    /// Exchanges the contents and storage of two bitmaps.
+    void swap(Bitmap<T> &other);
     /// Bitmap width in pixels.
     int width() const;
     /// Bitmap height in pixels.
     int height() const;
+    /// Number of pixels between the starts of consecutive rows.
+    int stride() const;
+    /// Returns the stride of a bitmap of the given width that allocates its own storage.
+    static int strideOf(int width);
     T & operator()(int x, int y);
     const T & operator()(int x, int y) const;
+    /// Returns a pointer to the first pixel of row y.
+    T * row(int y);
+    const T * row(int y) const;
 
 private:
+    char *storage;
+    size_t capacity;
     T *content;
     int w, h;
+    int rowStride;
+
+    void allocate(int width, int height);
 
 };
 
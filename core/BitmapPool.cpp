@@ -0,0 +1,85 @@
+
+#include "BitmapPool.h"
+
+#include <deque>
+#ifdef MSDFGEN_USE_CPP11
+    #include <mutex>
+#endif
+
+namespace msdfgen {
+
+template <typename T>
+struct BitmapPool<T>::Bitmaps {
+    /// The first count bitmaps hold released storage, the rest are empty slots kept for later releases.
+    /// A deque never relocates them, which would copy their storage.
+    std::deque<Bitmap<T> > released;
+    size_t count;
+#ifdef MSDFGEN_USE_CPP11
+    std::mutex mutex;
+#endif
+
+    Bitmaps() : count(0) { }
+};
+
+template <typename T>
+BitmapPool<T>::BitmapPool() : bitmaps(new Bitmaps) { }
+
+template <typename T>
+BitmapPool<T>::~BitmapPool() {
+    delete bitmaps;
+}
+
+template <typename T>
+void BitmapPool<T>::acquire(Bitmap<T> &bitmap, int width, int height) {
+    Bitmap<T> recycled;
+    {
+#ifdef MSDFGEN_USE_CPP11
+        std::lock_guard<std::mutex> lock(bitmaps->mutex);
+#endif
+        if (bitmaps->count)
+            recycled.swap(bitmaps->released[--bitmaps->count]);
+    }
+    // The previous storage of the bitmap is freed with recycled
+    bitmap.swap(recycled);
+    bitmap.resize(width, height);
+}
+
+template <typename T>
+void BitmapPool<T>::release(Bitmap<T> &bitmap) {
+    if (!bitmap.width() || !bitmap.height())
+        return;
+#ifdef MSDFGEN_USE_CPP11
+    std::lock_guard<std::mutex> lock(bitmaps->mutex);
+#endif
+    // A slot is only added when more bitmaps are released than ever before
+    if (bitmaps->count == bitmaps->released.size())
+        bitmaps->released.push_back(Bitmap<T>());
+    bitmaps->released[bitmaps->count++].swap(bitmap);
+}
+
+template <typename T>
+void BitmapPool<T>::clear() {
+#ifdef MSDFGEN_USE_CPP11
+    std::lock_guard<std::mutex> lock(bitmaps->mutex);
+#endif
+    bitmaps->released.clear();
+    bitmaps->count = 0;
+}
+
+template <typename T>
+BitmapPool<T> & BitmapPool<T>::shared() {
+    static BitmapPool<T> pool;
+    return pool;
+}
+
+template class BitmapPool<float>;
+template class BitmapPool<FloatRGB>;
+template class BitmapPool<FloatRGBA>;
+template class BitmapPool<unsigned char>;
+template class BitmapPool<ByteRGB>;
+template class BitmapPool<ByteRGBA>;
+template class BitmapPool<Half>;
+template class BitmapPool<HalfRGB>;
+template class BitmapPool<HalfRGBA>;
+
+}
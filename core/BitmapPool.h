@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include "Bitmap.h"
+
+namespace msdfgen {
+
+/** Recycles the storage of temporary bitmaps, so that generating the distance fields of many glyphs in a row
+ *  does not allocate memory for each one. Each released bitmap keeps its storage, which only grows when
+ *  a larger bitmap is acquired. Without MSDFGEN_USE_CPP11, the pool must only be used by one thread at a time.
+ */
+template <typename T>
+class BitmapPool {
+
+public:
+    BitmapPool();
+    ~BitmapPool();
+    /// Replaces the bitmap with one of width x height pixels, whose storage is taken from the pool if possible. Its contents are undefined.
+    void acquire(Bitmap<T> &bitmap, int width, int height);
+    /// Returns the storage of the bitmap to the pool and leaves the bitmap empty.
+    void release(Bitmap<T> &bitmap);
+    /// Frees the storage of all bitmaps in the pool.
+    void clear();
+
+    /// Returns the pool shared by the distance field generators.
+    static BitmapPool<T> & shared();
+
+private:
+    struct Bitmaps;
+
+    Bitmaps *bitmaps;
+
+    BitmapPool(const BitmapPool<T> &);
+    BitmapPool<T> & operator=(const BitmapPool<T> &);
+
+};
+
+}
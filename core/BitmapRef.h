@@ -0,0 +1,78 @@
+
+#pragma once
+
+#include <cstddef>
+#include "Bitmap.h"
+
+namespace msdfgen {
+
+/// A non-owning reference to a rectangular region of pixels, such as a whole bitmap or a part of one.
+/// Consecutive rows of the region are stride pixels apart.
+template <typename T>
+class BitmapRef {
+
+public:
+    BitmapRef();
+    /// References caller-owned memory, such as a mapped texture, in which consecutive rows are stride pixels apart.
+    BitmapRef(T *pixels, int width, int height, int stride);
+    /// References the whole bitmap, which must outlive the reference.
+    BitmapRef(Bitmap<T> &bitmap);
+    /// Returns the region of width x height pixels whose first pixel is at x, y.
+    BitmapRef<T> region(int x, int y, int width, int height) const;
+    /// Region width in pixels.
+    int width() const;
+    /// Region height in pixels.
+    int height() const;
+    /// Number of pixels between the starts of consecutive rows.
+    int stride() const;
+    T & operator()(int x, int y) const;
+    /// Returns a pointer to the first pixel of row y.
+    T * row(int y) const;
+
+private:
+    T *pixels;
+    int w, h;
+    int rowStride;
+
+};
+
+template <typename T>
+inline BitmapRef<T>::BitmapRef() : pixels(NULL), w(0), h(0), rowStride(0) { }
+
+template <typename T>
+inline BitmapRef<T>::BitmapRef(T *pixels, int width, int height, int stride) : pixels(pixels), w(width), h(height), rowStride(stride) { }
+
+template <typename T>
+inline BitmapRef<T>::BitmapRef(Bitmap<T> &bitmap) : pixels(bitmap.width() && bitmap.height() ? bitmap.row(0) : NULL), w(bitmap.width()), h(bitmap.height()), rowStride(bitmap.stride()) { }
+
+template <typename T>
+inline BitmapRef<T> BitmapRef<T>::region(int x, int y, int width, int height) const {
+    return BitmapRef<T>(pixels+(ptrdiff_t) rowStride*y+x, width, height, rowStride);
+}
+
+template <typename T>
+inline int BitmapRef<T>::width() const {
+    return w;
+}
+
+template <typename T>
+inline int BitmapRef<T>::height() const {
+    return h;
+}
+
+template <typename T>
+inline int BitmapRef<T>::stride() const {
+    return rowStride;
+}
+
+template <typename T>
+inline T & BitmapRef<T>::operator()(int x, int y) const {
+    return pixels[(ptrdiff_t) rowStride*y+x];
+}
+
+template <typename T>
+inline T * BitmapRef<T>::row(int y) const {
+    return pixels+(ptrdiff_t) rowStride*y;
+}
+
+}
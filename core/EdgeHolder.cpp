@@ -1,45 +1,100 @@
 
 #include "EdgeHolder.h"
 
+#include <new>
+
 namespace msdfgen {
 
-EdgeHolder::EdgeHolder() : edgeSegment(NULL) { }
+EdgeHolder::EdgeHolder() : edgeSegment(NULL), storage(EMPTY) { }
 
-EdgeHolder::EdgeHolder(EdgeSegment *segment) : edgeSegment(segment) { }
+EdgeHolder::EdgeHolder(EdgeSegment *segment) : edgeSegment(segment), storage(segment ? HEAP : EMPTY) { }
 
-EdgeHolder::EdgeHolder(Point2 p0, Point2 p1, EdgeColor edgeColor) : edgeSegment(new LinearSegment(p0, p1, edgeColor)) { }
+EdgeHolder::EdgeHolder(Point2 p0, Point2 p1, EdgeColor edgeColor) : storage(INLINE_LINEAR) {
+    edgeSegment = new (segmentMemory.bytes) LinearSegment(p0, p1, edgeColor);
+}
 
-EdgeHolder::EdgeHolder(Point2 p0, Point2 p1, Point2 p2, EdgeColor edgeColor) : edgeSegment(new QuadraticSegment(p0, p1, p2, edgeColor)) { }
+EdgeHolder::EdgeHolder(Point2 p0, Point2 p1, Point2 p2, EdgeColor edgeColor) : storage(INLINE_QUADRATIC) {
+    edgeSegment = new (segmentMemory.bytes) QuadraticSegment(p0, p1, p2, edgeColor);
+}
 
-EdgeHolder::EdgeHolder(Point2 p0, Point2 p1, Point2 p2, Point2 p3, EdgeColor edgeColor) : edgeSegment(new CubicSegment(p0, p1, p2, p3, edgeColor)) { }
+EdgeHolder::EdgeHolder(Point2 p0, Point2 p1, Point2 p2, Point2 p3, EdgeColor edgeColor) : storage(INLINE_CUBIC) {
+    edgeSegment = new (segmentMemory.bytes) CubicSegment(p0, p1, p2, p3, edgeColor);
+}
 
-EdgeHolder::EdgeHolder(const EdgeHolder &orig) : edgeSegment(orig.edgeSegment ? orig.edgeSegment->clone() : NULL) { }
+EdgeHolder::EdgeHolder(const EdgeHolder &orig) {
+    copy(orig);
+}
 
 #ifdef MSDFGEN_USE_CPP11
-EdgeHolder::EdgeHolder(EdgeHolder &&orig) : edgeSegment(orig.edgeSegment) {
-    orig.edgeSegment = NULL;
+EdgeHolder::EdgeHolder(EdgeHolder &&orig) {
+    if (orig.storage == HEAP) {
+        edgeSegment = orig.edgeSegment;
+        storage = HEAP;
+        orig.edgeSegment = NULL;
+        orig.storage = EMPTY;
+    } else
+        copy(orig);
 }
 #endif
 
 EdgeHolder::~EdgeHolder() {
-    delete edgeSegment;
+    destroy();
 }
 
 EdgeHolder & EdgeHolder::operator=(const EdgeHolder &orig) {
-    delete edgeSegment;
-    edgeSegment = orig.edgeSegment ? orig.edgeSegment->clone() : NULL;
+    if (this != &orig) {
+        destroy();
+        copy(orig);
+    }
     return *this;
 }
 
 #ifdef MSDFGEN_USE_CPP11
 EdgeHolder & EdgeHolder::operator=(EdgeHolder &&orig) {
-    delete edgeSegment;
-    edgeSegment = orig.edgeSegment;
-    orig.edgeSegment = NULL;
+    if (this != &orig) {
+        destroy();
+        if (orig.storage == HEAP) {
+            edgeSegment = orig.edgeSegment;
+            storage = HEAP;
+            orig.edgeSegment = NULL;
+            orig.storage = EMPTY;
+        } else
+            copy(orig);
+    }
     return *this;
 }
 #endif
 
+/// Copies the segment of orig into an empty holder. Inline segments are copied in place, others are cloned.
+void EdgeHolder::copy(const EdgeHolder &orig) {
+    storage = orig.storage;
+    switch (storage) {
+        case INLINE_LINEAR:
+            edgeSegment = new (segmentMemory.bytes) LinearSegment(static_cast<const LinearSegment &>(*orig.edgeSegment));
+            break;
+        case INLINE_QUADRATIC:
+            edgeSegment = new (segmentMemory.bytes) QuadraticSegment(static_cast<const QuadraticSegment &>(*orig.edgeSegment));
+            break;
+        case INLINE_CUBIC:
+            edgeSegment = new (segmentMemory.bytes) CubicSegment(static_cast<const CubicSegment &>(*orig.edgeSegment));
+            break;
+        case HEAP:
+            edgeSegment = orig.edgeSegment->clone();
+            break;
+        default:
+            edgeSegment = NULL;
+    }
+}
+
+void EdgeHolder::destroy() {
+    if (storage == HEAP)
+        delete edgeSegment;
+    else if (edgeSegment)
+        edgeSegment->~EdgeSegment();
+    edgeSegment = NULL;
+    storage = EMPTY;
+}
+
 EdgeSegment & EdgeHolder::operator*() {
     return *edgeSegment;
 }
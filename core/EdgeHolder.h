@@ -5,11 +5,15 @@
 
 namespace msdfgen {
 
-/// Container for a single edge of dynamic type.
+/** Container for a single edge of dynamic type. The segments created from control points are stored inline,
+ *  so that holding, copying and moving edges does not allocate memory, and the edges of a contour are contiguous.
+ */
 class EdgeHolder {
 
 public:
     EdgeHolder();
+    /// Takes ownership of a segment allocated with new, which stays on the heap. Copies of the holder clone it.
+    /// The distance field generators only support the linear, quadratic and cubic segments, see Shape::validate.
     EdgeHolder(EdgeSegment *segment);
     EdgeHolder(Point2 p0, Point2 p1, EdgeColor edgeColor = WHITE);
     EdgeHolder(Point2 p0, Point2 p1, Point2 p2, EdgeColor edgeColor = WHITE);
@@ -31,7 +35,24 @@ public:
     operator const EdgeSegment *() const;
 
 private:
+    enum Storage {
+        EMPTY,
+        INLINE_LINEAR,
+        INLINE_QUADRATIC,
+        INLINE_CUBIC,
+        HEAP
+    };
+
     EdgeSegment *edgeSegment;
+    Storage storage;
+    /// Memory of the inline segment, which fits the largest segment type.
+    union {
+        double alignment;
+        char bytes[sizeof(CubicSegment)];
+    } segmentMemory;
+
+    void copy(const EdgeHolder &orig);
+    void destroy();
 
 };
 
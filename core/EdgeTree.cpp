@@ -0,0 +1,84 @@
+
+#include "EdgeTree.h"
+
+#include <algorithm>
+#include "arithmetics.hpp"
+
+namespace msdfgen {
+
+class EdgeCentroidOrder {
+
+public:
+    EdgeCentroidOrder(const std::vector<double> &boxes, int axis) : boxes(boxes), axis(axis) { }
+    bool operator()(int a, int b) const {
+        double ca = boxes[4*a+axis]+boxes[4*a+axis+2];
+        double cb = boxes[4*b+axis]+boxes[4*b+axis+2];
+        return ca < cb || (ca == cb && a < b);
+    }
+
+private:
+    const std::vector<double> &boxes;
+    int axis;
+
+};
+
+EdgeTree::EdgeTree() { }
+
+EdgeTree::EdgeTree(const FlatShape &shape, int contour) {
+    int firstEdge = shape.contourStarts[contour];
+    int edgeCount = shape.contourStarts[contour+1]-firstEdge;
+    if (!edgeCount)
+        return;
+    std::vector<double> boxes(shape.edgeBounds.begin()+4*firstEdge, shape.edgeBounds.begin()+4*(firstEdge+edgeCount));
+    std::vector<int> colors(shape.edgeColors.begin()+firstEdge, shape.edgeColors.begin()+firstEdge+edgeCount);
+    std::vector<int> order(edgeCount);
+    double extent = 0;
+    for (int i = 0; i < edgeCount; ++i) {
+        for (int j = 0; j < 4; ++j)
+            extent = max(extent, fabs(boxes[4*i+j]));
+        order[i] = i;
+    }
+    nodes.reserve(2*edgeCount);
+    indices.reserve(edgeCount);
+    build(order, boxes, colors, 0, edgeCount, 1e-9*extent);
+    for (std::vector<int>::iterator index = indices.begin(); index != indices.end(); ++index)
+        *index += firstEdge;
+}
+
+bool EdgeTree::empty() const {
+    return nodes.empty();
+}
+
+int EdgeTree::build(std::vector<int> &order, const std::vector<double> &boxes, const std::vector<int> &colors, int begin, int end, double margin) {
+    int index = nodes.size();
+    nodes.resize(index+1);
+    Node node;
+    node.l = node.b = 1e240, node.r = node.t = -1e240;
+    node.colors = 0;
+    node.start = 0, node.count = 0;
+    node.second = 0;
+    double cl = 1e240, cb = 1e240, cr = -1e240, ct = -1e240;
+    for (int i = begin; i < end; ++i) {
+        const double *box = &boxes[4*order[i]];
+        node.l = min(node.l, box[0]-margin), node.b = min(node.b, box[1]-margin);
+        node.r = max(node.r, box[2]+margin), node.t = max(node.t, box[3]+margin);
+        node.colors |= colors[order[i]];
+        cl = min(cl, box[0]+box[2]), cb = min(cb, box[1]+box[3]);
+        cr = max(cr, box[0]+box[2]), ct = max(ct, box[1]+box[3]);
+    }
+    if (end-begin <= MSDFGEN_EDGE_TREE_LEAF_SIZE) {
+        node.start = indices.size();
+        node.count = end-begin;
+        indices.insert(indices.end(), order.begin()+begin, order.begin()+end);
+    } else {
+        // Median split along the longer axis of the edge centroids
+        int mid = (begin+end)/2;
+        std::nth_element(order.begin()+begin, order.begin()+mid, order.begin()+end, EdgeCentroidOrder(boxes, ct-cb > cr-cl));
+        build(order, boxes, colors, begin, mid, margin);
+        node.second = build(order, boxes, colors, mid, end, margin);
+    }
+    nodes[index] = node;
+    return index;
+}
+
+}
@@ -0,0 +1,86 @@
+
+#pragma once
+
+#include <vector>
+#include "Vector2.h"
+#include "FlatShape.h"
+
+namespace msdfgen {
+
+// Maximum number of edges stored in a single leaf of an edge tree.
+#define MSDFGEN_EDGE_TREE_LEAF_SIZE 4
+
+/// A bounding volume hierarchy over the edges of a contour, used to cull distant edges in nearest edge queries.
+/// Edges are identified by their index in the flat shape.
+class EdgeTree {
+
+public:
+    struct Node {
+        /// Bounding box of the edges in the subtree, inflated by a small margin to absorb rounding errors.
+        double l, b, r, t;
+        /// Union of the colors of the edges in the subtree.
+        int colors;
+        /// For leaves, the range of edge indices in the subtree. Inner nodes have zero count.
+        int start, count;
+        /// For inner nodes, the index of the second child. The first child immediately follows its parent.
+        int second;
+
+        /// Returns the squared distance between the box spanned by lo and hi and the node's bounding box.
+        double distanceSquared(const Point2 &lo, const Point2 &hi) const;
+    };
+
+    EdgeTree();
+    EdgeTree(const FlatShape &shape, int contour);
+    /// Returns true if the tree contains no edges.
+    bool empty() const;
+    /** Visits all edges that may be closer to any point in the box spanned by lo and hi than the visitor's current
+     *  nearest edges, nearest subtrees first. The visitor must provide bool cull(const Node &node) const, returning true
+     *  if no edge in the node's subtree can be of interest, and void visit(int index) for the edge at index.
+     *  Because edges are not visited in order, the visitor must break ties by edge index to match a linear scan.
+     */
+    template <class Visitor>
+    void query(const Point2 &lo, const Point2 &hi, Visitor &visitor) const;
+
+private:
+    std::vector<Node> nodes;
+    std::vector<int> indices;
+
+    int build(std::vector<int> &order, const std::vector<double> &boxes, const std::vector<int> &colors, int begin, int end, double margin);
+
+};
+
+inline double EdgeTree::Node::distanceSquared(const Point2 &lo, const Point2 &hi) const {
+    double dx = hi.x < l ? l-hi.x : lo.x > r ? lo.x-r : 0;
+    double dy = hi.y < b ? b-hi.y : lo.y > t ? lo.y-t : 0;
+    return dx*dx+dy*dy;
+}
+
+template <class Visitor>
+void EdgeTree::query(const Point2 &lo, const Point2 &hi, Visitor &visitor) const {
+    if (nodes.empty())
+        return;
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const Node &node = nodes[stack[--top]];
+        if (visitor.cull(node))
+            continue;
+        if (node.count) {
+            for (int i = node.start; i < node.start+node.count; ++i)
+                visitor.visit(indices[i]);
+        } else {
+            int first = int(&node-&nodes[0])+1, second = node.second;
+            // Push the farther child first so that the nearer one is processed first
+            if (nodes[first].distanceSquared(lo, hi) < nodes[second].distanceSquared(lo, hi)) {
+                stack[top++] = second;
+                stack[top++] = first;
+            } else {
+                stack[top++] = first;
+                stack[top++] = second;
+            }
+        }
+    }
+}
+
+}
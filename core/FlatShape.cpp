@@ -0,0 +1,227 @@
+
+#include "FlatShape.h"
+
+#include "arithmetics.hpp"
+#include "equation-solver.h"
+
+namespace msdfgen {
+
+FlatShape::FlatShape() : inverseYAxis(false) { }
+
+FlatShape::FlatShape(const Shape &shape) : inverseYAxis(shape.inverseYAxis) {
+    int edgeCount = 0;
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
+        edgeCount += contour->edges.size();
+    edgeTypes.reserve(edgeCount);
+    edgeColors.reserve(edgeCount);
+    edgeContours.reserve(edgeCount);
+    edgeOffsets.reserve(edgeCount);
+    edgeBounds.reserve(4*edgeCount);
+    startPoints.reserve(edgeCount), endPoints.reserve(edgeCount);
+    startDirections.reserve(edgeCount), endDirections.reserve(edgeCount);
+    contourStarts.reserve(shape.contours.size()+1);
+    windings.reserve(shape.contours.size());
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        contourStarts.push_back(edgeTypes.size());
+        windings.push_back(contour->winding());
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            if (const LinearSegment *e = dynamic_cast<const LinearSegment *>(&**edge)) {
+                edgeTypes.push_back(LINEAR);
+                edgeOffsets.push_back(linearTerms.size());
+                linearPoints.insert(linearPoints.end(), e->p, e->p+2);
+                linearTerms.push_back(LinearSegmentTerms());
+                prepareLinearSegment(e->p, linearTerms.back());
+            } else if (const QuadraticSegment *e = dynamic_cast<const QuadraticSegment *>(&**edge)) {
+                edgeTypes.push_back(QUADRATIC);
+                edgeOffsets.push_back(quadraticTerms.size());
+                quadraticPoints.insert(quadraticPoints.end(), e->p, e->p+3);
+                quadraticTerms.push_back(QuadraticSegmentTerms());
+                prepareQuadraticSegment(e->p, quadraticTerms.back());
+            } else if (const CubicSegment *e = dynamic_cast<const CubicSegment *>(&**edge)) {
+                edgeTypes.push_back(CUBIC);
+                edgeOffsets.push_back(cubicTerms.size());
+                cubicPoints.insert(cubicPoints.end(), e->p, e->p+4);
+                cubicTerms.push_back(CubicSegmentTerms());
+                prepareCubicSegment(e->p, cubicTerms.back());
+            } else {
+                // Other segment types are rejected by Shape::validate
+                continue;
+            }
+            edgeColors.push_back((*edge)->color);
+            edgeContours.push_back(int(contour-shape.contours.begin()));
+            double l = 1e240, b = 1e240, r = -1e240, t = -1e240;
+            (*edge)->bounds(l, b, r, t);
+            edgeBounds.push_back(l), edgeBounds.push_back(b), edgeBounds.push_back(r), edgeBounds.push_back(t);
+            startPoints.push_back((*edge)->point(0));
+            endPoints.push_back((*edge)->point(1));
+            startDirections.push_back((*edge)->direction(0).normalize());
+            endDirections.push_back((*edge)->direction(1).normalize());
+        }
+    }
+    contourStarts.push_back(edgeTypes.size());
+}
+
+static Point2 bezierPoint(const Point2 *p, int degree, double t) {
+    Point2 q[4];
+    for (int i = 0; i <= degree; ++i)
+        q[i] = p[i];
+    for (int n = degree; n > 0; --n)
+        for (int i = 0; i < n; ++i)
+            q[i] = mix(q[i], q[i+1], t);
+    return q[0];
+}
+
+int FlatShape::contourCount() const {
+    return windings.size();
+}
+
+int FlatShape::edgeCount() const {
+    return edgeTypes.size();
+}
+
+SignedDistance FlatShape::signedDistance(int edge, Point2 origin, double &param) const {
+    int i = edgeOffsets[edge];
+    switch (edgeTypes[edge]) {
+        case LINEAR:
+            return linearSignedDistance(&linearPoints[2*i], linearTerms[i], origin, param);
+        case QUADRATIC:
+            return quadraticSignedDistance(&quadraticPoints[3*i], quadraticTerms[i], origin, param);
+        default:
+            return cubicSignedDistance(&cubicPoints[4*i], cubicTerms[i], origin, param);
+    }
+}
+
+void FlatShape::signedDistanceBatch(int edge, const double *x, const double *y, SignedDistance *distances, double *params) const {
+    int i = edgeOffsets[edge];
+    switch (edgeTypes[edge]) {
+        case LINEAR:
+            if (edgeKernels().linearSignedDistance(&linearPoints[2*i], linearTerms[i], x, y, distances, params))
+                return;
+            break;
+        case QUADRATIC:
+            if (edgeKernels().quadraticSignedDistance(&quadraticPoints[3*i], quadraticTerms[i], x, y, distances, params))
+                return;
+            break;
+    }
+    for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i)
+        distances[i] = signedDistance(edge, Point2(x[i], y[i]), params[i]);
+}
+
+void FlatShape::distanceToPseudoDistance(int edge, SignedDistance &distance, Point2 origin, double param) const {
+    if (param < 0) {
+        Vector2 aq = origin-startPoints[edge];
+        double ts = dotProduct(aq, startDirections[edge]);
+        if (ts < 0) {
+            double pseudoDistance = crossProduct(aq, startDirections[edge]);
+            if (fabs(pseudoDistance) <= fabs(distance.distance)) {
+                distance.distance = pseudoDistance;
+                distance.dot = 0;
+            }
+        }
+    } else if (param > 1) {
+        Vector2 bq = origin-endPoints[edge];
+        double ts = dotProduct(bq, endDirections[edge]);
+        if (ts > 0) {
+            double pseudoDistance = crossProduct(bq, endDirections[edge]);
+            if (fabs(pseudoDistance) <= fabs(distance.distance)) {
+                distance.distance = pseudoDistance;
+                distance.dot = 0;
+            }
+        }
+    }
+}
+
+int FlatShape::controlPoints(int edge, const Point2 *&points) const {
+    switch (edgeTypes[edge]) {
+        case LINEAR:
+            points = &linearPoints[2*edgeOffsets[edge]];
+            return 1;
+        case QUADRATIC:
+            points = &quadraticPoints[3*edgeOffsets[edge]];
+            return 2;
+        default:
+            points = &cubicPoints[4*edgeOffsets[edge]];
+            return 3;
+    }
+}
+
+int FlatShape::scanlineIntersections(int edge, double x[3], int dy[3], double y) const {
+    const Point2 *p;
+    int degree = controlPoints(edge, p);
+    // Split the edge at the extremes of its Y coordinate into monotonic parts
+    double splits[4];
+    int splitCount = 0;
+    splits[splitCount++] = 0;
+    if (degree == 2) {
+        double a = p[0].y-2*p[1].y+p[2].y;
+        if (a != 0) {
+            double t = (p[0].y-p[1].y)/a;
+            if (t > 0 && t < 1)
+                splits[splitCount++] = t;
+        }
+    } else if (degree == 3) {
+        double a = p[1].y-p[0].y, b = p[2].y-p[1].y, c = p[3].y-p[2].y;
+        double roots[2];
+        int rootCount = solveQuadratic(roots, a-2*b+c, 2*(b-a), a);
+        if (rootCount == 2 && roots[1] < roots[0]) {
+            double tmp = roots[0];
+            roots[0] = roots[1];
+            roots[1] = tmp;
+        }
+        for (int i = 0; i < rootCount; ++i)
+            if (roots[i] > splits[splitCount-1] && roots[i] < 1)
+                splits[splitCount++] = roots[i];
+    }
+    splits[splitCount] = 1;
+
+    int count = 0;
+    Point2 a = p[0];
+    for (int i = 0; i < splitCount; ++i) {
+        Point2 b = i+1 == splitCount ? p[degree] : bezierPoint(p, degree, splits[i+1]);
+        if ((a.y <= y && y < b.y) || (b.y <= y && y < a.y)) {
+            dy[count] = b.y > a.y ? 1 : -1;
+            if (degree == 1)
+                x[count] = a.x+(y-a.y)/(b.y-a.y)*(b.x-a.x);
+            else {
+                // Bisect the monotonic part and interpolate between the final bounds
+                double lo = splits[i], hi = splits[i+1];
+                Point2 loPoint = a, hiPoint = b;
+                for (int j = 0; j < 32; ++j) {
+                    double mid = .5*(lo+hi);
+                    Point2 midPoint = bezierPoint(p, degree, mid);
+                    if ((midPoint.y <= y) == (a.y <= y))
+                        lo = mid, loPoint = midPoint;
+                    else
+                        hi = mid, hiPoint = midPoint;
+                }
+                x[count] = loPoint.y == hiPoint.y ? loPoint.x : loPoint.x+(y-loPoint.y)/(hiPoint.y-loPoint.y)*(hiPoint.x-loPoint.x);
+            }
+            ++count;
+        }
+        a = b;
+    }
+    return count;
+}
+
+void FlatShape::scanline(Scanline &line, double y) const {
+    std::vector<Scanline::Intersection> intersections;
+    for (int edge = 0; edge < edgeCount(); ++edge) {
+        const Point2 *p;
+        int degree = controlPoints(edge, p);
+        double lo = p[0].y, hi = p[0].y;
+        for (int i = 1; i <= degree; ++i)
+            lo = min(lo, p[i].y), hi = max(hi, p[i].y);
+        if (y < lo || y >= hi)
+            continue;
+        double x[3];
+        int dy[3];
+        int count = scanlineIntersections(edge, x, dy, y);
+        for (int i = 0; i < count; ++i) {
+            Scanline::Intersection intersection = { x[i], dy[i] };
+            intersections.push_back(intersection);
+        }
+    }
+    line.setIntersections(intersections);
+}
+
+}
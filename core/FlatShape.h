@@ -0,0 +1,72 @@
+
+#pragma once
+
+#include <vector>
+#include "Shape.h"
+#include "edge-kernels.h"
+#include "Scanline.h"
+
+namespace msdfgen {
+
+/// A read-only compiled copy of a shape's geometry for distance field generation. Edges are indexed consecutively
+/// across all contours and their control points are packed into contiguous arrays by segment type.
+class FlatShape {
+
+public:
+    enum EdgeType {
+        LINEAR,
+        QUADRATIC,
+        CUBIC
+    };
+
+    /// The type of each edge.
+    std::vector<int> edgeTypes;
+    /// The color of each edge.
+    std::vector<int> edgeColors;
+    /// The index of the contour each edge belongs to.
+    std::vector<int> edgeContours;
+    /// The index of each edge among the edges of its type, which locates its control points and prepared terms.
+    std::vector<int> edgeOffsets;
+    /// Bounding box of each edge as four consecutive values (left, bottom, right, top).
+    std::vector<double> edgeBounds;
+    /// Control points of the linear, quadratic and cubic edges.
+    std::vector<Point2> linearPoints, quadraticPoints, cubicPoints;
+    /// Terms of the signed distance to the linear, quadratic and cubic edges precomputed from their control points.
+    std::vector<LinearSegmentTerms> linearTerms;
+    std::vector<QuadraticSegmentTerms> quadraticTerms;
+    std::vector<CubicSegmentTerms> cubicTerms;
+    /// Endpoints of each edge.
+    std::vector<Point2> startPoints, endPoints;
+    /// Normalized directions of each edge at its endpoints.
+    std::vector<Vector2> startDirections, endDirections;
+    /// The index of the first edge of each contour, followed by the total number of edges.
+    std::vector<int> contourStarts;
+    /// The winding of each contour.
+    std::vector<int> windings;
+    /// Specifies whether the shape uses bottom-to-top (false) or top-to-bottom (true) Y coordinates.
+    bool inverseYAxis;
+
+    FlatShape();
+    /// Compiles a shape that passes Shape::validate, so that all of its edges are linear, quadratic or cubic segments.
+    explicit FlatShape(const Shape &shape);
+    /// Returns the number of contours.
+    int contourCount() const;
+    /// Returns the total number of edges.
+    int edgeCount() const;
+    /// Returns the minimum signed distance between origin and the edge.
+    SignedDistance signedDistance(int edge, Point2 origin, double &param) const;
+    /// Computes signedDistance for a batch of MSDFGEN_DISTANCE_BATCH points given by their coordinates.
+    void signedDistanceBatch(int edge, const double *x, const double *y, SignedDistance *distances, double *params) const;
+    /// Converts a previously retrieved signed distance from origin to pseudo-distance.
+    void distanceToPseudoDistance(int edge, SignedDistance &distance, Point2 origin, double param) const;
+    /// Sets points to the control points of the edge and returns its degree (1 to 3).
+    int controlPoints(int edge, const Point2 *&points) const;
+    /// Computes the intersections of the edge with the horizontal line at y and returns their number.
+    /// Each vertically monotonic part of the edge covers the half-open interval from its lower to its upper end.
+    int scanlineIntersections(int edge, double x[3], int dy[3], double y) const;
+    /// Computes the intersections of the shape with the horizontal line at y.
+    void scanline(Scanline &line, double y) const;
+
+};
+
+}
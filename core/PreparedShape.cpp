@@ -0,0 +1,15 @@
+
+#include "PreparedShape.h"
+
+namespace msdfgen {
+
+PreparedShape::PreparedShape() { }
+
+PreparedShape::PreparedShape(const Shape &shape) : shape(shape) {
+    int contourCount = this->shape.contourCount();
+    trees.reserve(contourCount);
+    for (int i = 0; i < contourCount; ++i)
+        trees.push_back(EdgeTree(this->shape, i));
+}
+
+}
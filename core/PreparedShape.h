@@ -0,0 +1,29 @@
+
+#pragma once
+
+#include <vector>
+#include "Shape.h"
+#include "FlatShape.h"
+#include "EdgeTree.h"
+
+namespace msdfgen {
+
+/** A shape compiled for distance field generation, with the terms of each edge's signed distance precomputed
+ *  and an edge tree built for each contour. Preparing a shape once and passing it to the generators avoids
+ *  repeating this work when the same shape is generated several times, for example at different scales.
+ *  The prepared shape is a copy, so later modifications of the original shape do not affect it.
+ */
+class PreparedShape {
+
+public:
+    /// The compiled geometry of the shape.
+    FlatShape shape;
+    /// The edge tree of each contour.
+    std::vector<EdgeTree> trees;
+
+    PreparedShape();
+    explicit PreparedShape(const Shape &shape);
+
+};
+
+}
@@ -0,0 +1,56 @@
+
+#include "Scanline.h"
+
+#include <algorithm>
+
+namespace msdfgen {
+
+static bool compareIntersections(const Scanline::Intersection &a, const Scanline::Intersection &b) {
+    return a.x < b.x;
+}
+
+bool interpretFillRule(int winding, FillRule fillRule) {
+    switch (fillRule) {
+        case FILL_NONZERO:
+            return winding != 0;
+        case FILL_ODD:
+            return (winding&1) != 0;
+        case FILL_POSITIVE:
+            return winding > 0;
+        case FILL_NEGATIVE:
+            return winding < 0;
+    }
+    return false;
+}
+
+Scanline::Scanline() { }
+
+void Scanline::setIntersections(const std::vector<Intersection> &intersections) {
+    this->intersections = intersections;
+    std::sort(this->intersections.begin(), this->intersections.end(), compareIntersections);
+    windings.resize(this->intersections.size());
+    int total = 0;
+    for (int i = 0; i < (int) this->intersections.size(); ++i) {
+        total += this->intersections[i].direction;
+        windings[i] = total;
+    }
+}
+
+int Scanline::winding(double x) const {
+    // Binary search for the number of intersections left of x, which keeps concurrent queries safe
+    int lo = 0, hi = intersections.size();
+    while (lo < hi) {
+        int mid = (lo+hi)/2;
+        if (intersections[mid].x < x)
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+    return lo ? windings[lo-1] : 0;
+}
+
+bool Scanline::filled(double x, FillRule fillRule) const {
+    return interpretFillRule(winding(x), fillRule);
+}
+
+}
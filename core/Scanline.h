@@ -0,0 +1,50 @@
+
+#pragma once
+
+#include <vector>
+
+namespace msdfgen {
+
+/// Specifies which points are covered by the shape, given the winding number of its contours around them.
+enum FillRule {
+    /// Points with a nonzero winding number are filled.
+    FILL_NONZERO,
+    /// Points with an odd winding number are filled (even-odd rule).
+    FILL_ODD,
+    /// Points with a positive winding number are filled.
+    FILL_POSITIVE,
+    /// Points with a negative winding number are filled.
+    FILL_NEGATIVE
+};
+
+/// Returns true if a point with the specified winding number is filled according to the fill rule.
+bool interpretFillRule(int winding, FillRule fillRule);
+
+/// The intersections of a shape with a horizontal line, which determine the points of the line covered by the shape.
+class Scanline {
+
+public:
+    /// An intersection of an edge with the scanline.
+    struct Intersection {
+        /// X coordinate of the intersection.
+        double x;
+        /// The winding contributed to the points right of the intersection, 1 or -1 depending on the edge's vertical direction.
+        int direction;
+    };
+
+    Scanline();
+    /// Replaces the intersections of the scanline. They may be specified in any order.
+    void setIntersections(const std::vector<Intersection> &intersections);
+    /// Returns the winding number of the shape around the point at x, which is positive inside positively wound contours.
+    int winding(double x) const;
+    /// Returns true if the point at x is filled according to the fill rule.
+    bool filled(double x, FillRule fillRule) const;
+
+private:
+    std::vector<Intersection> intersections;
+    /// The winding number right of each intersection.
+    std::vector<int> windings;
+
+};
+
+}
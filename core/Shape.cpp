@@ -1,6 +1,10 @@
 
 #include "Shape.h"
 
+#ifdef MSDFGEN_USE_CPP11
+    #include <utility>
+#endif
+
 namespace msdfgen {
 
 Shape::Shape() : inverseYAxis(false) { }
@@ -27,6 +31,9 @@ bool Shape::validate() const {
             for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
                 if (!*edge)
                     return false;
+                // The distance field generators only evaluate the built-in segment types
+                if (!dynamic_cast<const LinearSegment *>(&**edge) && !dynamic_cast<const QuadraticSegment *>(&**edge) && !dynamic_cast<const CubicSegment *>(&**edge))
+                    return false;
                 if ((*edge)->point(0) != corner)
                     return false;
                 corner = (*edge)->point(1);
@@ -39,15 +46,38 @@ bool Shape::validate() const {
 void Shape::normalize() {
     for (std::vector<Contour>::iterator contour = contours.begin(); contour != contours.end(); ++contour)
         if (contour->edges.size() == 1) {
-            EdgeSegment *parts[3] = { };
+            EdgeHolder parts[3];
             contour->edges[0]->splitInThirds(parts[0], parts[1], parts[2]);
             contour->edges.clear();
-            contour->edges.push_back(EdgeHolder(parts[0]));
-            contour->edges.push_back(EdgeHolder(parts[1]));
-            contour->edges.push_back(EdgeHolder(parts[2]));
+            contour->edges.push_back(parts[0]);
+            contour->edges.push_back(parts[1]);
+            contour->edges.push_back(parts[2]);
         }
 }
 
+void Shape::approximateCubics(double tolerance) {
+    for (std::vector<Contour>::iterator contour = contours.begin(); contour != contours.end(); ++contour) {
+        std::vector<EdgeHolder> edges;
+        edges.reserve(contour->edges.size());
+        for (std::vector<EdgeHolder>::iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            if (const CubicSegment *cubic = dynamic_cast<const CubicSegment *>(&**edge)) {
+                EdgeHolder parts[MSDFGEN_CUBIC_APPROXIMATION_MAX_PARTS];
+                int partCount = cubic->approximateByQuadratics(parts, tolerance);
+                if (partCount) {
+                    edges.insert(edges.end(), parts, parts+partCount);
+                    continue;
+                }
+            }
+#ifdef MSDFGEN_USE_CPP11
+            edges.push_back(std::move(*edge));
+#else
+            edges.push_back(*edge);
+#endif
+        }
+        contour->edges.swap(edges);
+    }
+}
+
 void Shape::bounds(double &l, double &b, double &r, double &t) const {
     for (std::vector<Contour>::const_iterator contour = contours.begin(); contour != contours.end(); ++contour)
         contour->bounds(l, b, r, t);
@@ -25,7 +25,11 @@ public:
     Contour & addContour();
     /// Normalizes the shape geometry for distance field generation.
     void normalize();
+    /// Replaces cubic edges by quadratic edges that deviate from them by at most tolerance, which are faster to evaluate.
+    /// Edge colors and the directions at the original endpoints are preserved. Cubic edges that cannot be approximated are kept.
+    void approximateCubics(double tolerance);
     /// Performs basic checks to determine if the object represents a valid shape.
+    /// Shapes with edges other than linear, quadratic and cubic segments are not valid input for the generators.
     bool validate() const;
     /// Computes the shape's bounding box.
     void bounds(double &l, double &b, double &r, double &t) const;
@@ -0,0 +1,197 @@
+
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <vector>
+#ifdef MSDFGEN_USE_CPP11
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+#endif
+
+namespace msdfgen {
+
+#ifdef MSDFGEN_USE_CPP11
+
+/// A contiguous range of tasks that has not been started yet.
+struct TaskRange {
+    std::mutex mutex;
+    int begin, end;
+};
+
+struct ThreadPool::Workers {
+    std::vector<std::thread> threads;
+    std::vector<TaskRange> ranges;
+    std::mutex busy;
+    std::mutex mutex;
+    std::condition_variable start, finish;
+    Job *job;
+    int generation;
+    int active;
+    bool quit;
+
+    explicit Workers(int threadCount) : ranges(threadCount), job(NULL), generation(0), active(0), quit(false) {
+        threads.reserve(threadCount-1);
+        for (int i = 1; i < threadCount; ++i)
+            threads.push_back(std::thread(&Workers::work, this, i));
+    }
+
+    ~Workers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        start.notify_all();
+        for (std::vector<std::thread>::iterator thread = threads.begin(); thread != threads.end(); ++thread)
+            thread->join();
+    }
+
+    /// Takes the next task of the thread's own range, or steals the upper half of another thread's range.
+    bool next(int index, int &task) {
+        {
+            TaskRange &own = ranges[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin < own.end) {
+                task = own.begin++;
+                return true;
+            }
+        }
+        int threadCount = ranges.size();
+        for (int i = 1; i < threadCount; ++i) {
+            int begin, end;
+            {
+                TaskRange &victim = ranges[(index+i)%threadCount];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.begin >= victim.end)
+                    continue;
+                begin = victim.begin+(victim.end-victim.begin)/2;
+                end = victim.end;
+                victim.end = begin;
+            }
+            // Only this thread refills its own range, so it is still empty
+            task = begin++;
+            if (begin < end) {
+                TaskRange &own = ranges[index];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin;
+                own.end = end;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void participate(int index) {
+        int task;
+        while (next(index, task))
+            job->execute(task);
+    }
+
+    void work(int index) {
+        int lastGeneration = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!quit && generation == lastGeneration)
+                    start.wait(lock);
+                if (quit)
+                    return;
+                lastGeneration = generation;
+            }
+            participate(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!--active)
+                    finish.notify_one();
+            }
+        }
+    }
+
+};
+
+ThreadPool::ThreadPool(int threadCount) : workers(NULL) {
+    if (threadCount <= 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount > 1)
+        workers = new Workers(threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    delete workers;
+}
+
+int ThreadPool::threadCount() const {
+    return workers ? workers->ranges.size() : 1;
+}
+
+void ThreadPool::run(Job &job, int taskCount) {
+    if (workers && taskCount > 1 && workers->busy.try_lock()) {
+        int threadCount = workers->ranges.size();
+        for (int i = 0; i < threadCount; ++i) {
+            workers->ranges[i].begin = int((long long) taskCount*i/threadCount);
+            workers->ranges[i].end = int((long long) taskCount*(i+1)/threadCount);
+        }
+        {
+            std::lock_guard<std::mutex> lock(workers->mutex);
+            workers->job = &job;
+            workers->active = threadCount-1;
+            ++workers->generation;
+        }
+        workers->start.notify_all();
+        workers->participate(0);
+        {
+            std::unique_lock<std::mutex> lock(workers->mutex);
+            while (workers->active)
+                workers->finish.wait(lock);
+            workers->job = NULL;
+        }
+        workers->busy.unlock();
+    } else {
+        for (int i = 0; i < taskCount; ++i)
+            job.execute(i);
+    }
+}
+
+static std::mutex sharedMutex;
+
+#else
+
+ThreadPool::ThreadPool(int) : workers(NULL) { }
+
+ThreadPool::~ThreadPool() { }
+
+int ThreadPool::threadCount() const {
+    return 1;
+}
+
+void ThreadPool::run(Job &job, int taskCount) {
+    for (int i = 0; i < taskCount; ++i)
+        job.execute(i);
+}
+
+#endif
+
+static ThreadPool *sharedPool = NULL;
+static int sharedThreadCount = 0;
+
+ThreadPool & ThreadPool::shared() {
+#ifdef MSDFGEN_USE_CPP11
+    std::lock_guard<std::mutex> lock(sharedMutex);
+#endif
+    if (!sharedPool)
+        sharedPool = new ThreadPool(sharedThreadCount);
+    return *sharedPool;
+}
+
+void ThreadPool::setSharedThreadCount(int threadCount) {
+#ifdef MSDFGEN_USE_CPP11
+    std::lock_guard<std::mutex> lock(sharedMutex);
+#endif
+    if (sharedPool && threadCount == sharedThreadCount)
+        return;
+    delete sharedPool;
+    sharedPool = NULL;
+    sharedThreadCount = threadCount;
+}
+
+}
@@ -0,0 +1,46 @@
+
+#pragma once
+
+namespace msdfgen {
+
+/// A pool of worker threads that execute the independent tasks of a job in parallel.
+/// Each thread starts with an equal share of the tasks and steals from the others once it runs out.
+/// Without MSDFGEN_USE_CPP11, all tasks are executed by the calling thread.
+class ThreadPool {
+
+public:
+    /// A job consisting of a number of independent tasks.
+    class Job {
+
+    public:
+        virtual ~Job() { }
+        /// Executes the task of the specified index.
+        virtual void execute(int task) = 0;
+
+    };
+
+    /// Creates a pool of threadCount threads including the calling thread. Zero selects one thread per hardware thread.
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+    /// Returns the number of threads including the calling thread.
+    int threadCount() const;
+    /// Executes tasks 0 to taskCount-1 of the job and returns once all of them are finished.
+    /// If the pool is already running another job, the tasks are executed by the calling thread.
+    void run(Job &job, int taskCount);
+
+    /// Returns the pool shared by the distance field generators.
+    static ThreadPool & shared();
+    /// Sets the number of threads of the shared pool. Must not be called while the shared pool is running a job.
+    static void setSharedThreadCount(int threadCount);
+
+private:
+    struct Workers;
+
+    Workers *workers;
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool & operator=(const ThreadPool &);
+
+};
+
+}
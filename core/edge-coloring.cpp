@@ -56,7 +56,7 @@ void edgeColoringSimple(Shape &shape, double angleThreshold, unsigned long long
                     contour->edges[(corner+i)%m]->color = (colors+1)[int(3+2.875*i/(m-1)-1.4375+.5)-3];
             } else if (contour->edges.size() >= 1) {
                 // Less than three edge segments for three colors => edges must be split
-                EdgeSegment *parts[7] = { };
+                EdgeHolder parts[7];
                 contour->edges[0]->splitInThirds(parts[0+3*corner], parts[1+3*corner], parts[2+3*corner]);
                 if (contour->edges.size() >= 2) {
                     contour->edges[1]->splitInThirds(parts[3-3*corner], parts[4-3*corner], parts[5-3*corner]);
@@ -70,7 +70,7 @@ void edgeColoringSimple(Shape &shape, double angleThreshold, unsigned long long
                 }
                 contour->edges.clear();
                 for (int i = 0; parts[i]; ++i)
-                    contour->edges.push_back(EdgeHolder(parts[i]));
+                    contour->edges.push_back(parts[i]);
             }
         }
         // Multiple corners
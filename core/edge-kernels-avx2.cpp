@@ -0,0 +1,57 @@
+
+#include "edge-kernels.h"
+
+// This file must be compiled with AVX2 code generation enabled (-mavx2 or /arch:AVX2), otherwise it is empty
+#ifdef __AVX2__
+    #define MSDFGEN_AVX2_KERNELS
+    #include <immintrin.h>
+    #include "edge-kernels.hpp"
+#endif
+
+namespace msdfgen {
+
+#ifdef MSDFGEN_AVX2_KERNELS
+
+struct AVX2Lanes {
+    typedef double Scalar;
+    typedef __m256d V;
+
+    static V set1(double x) { return _mm256_set1_pd(x); }
+    static V load(const double *p) { return _mm256_loadu_pd(p); }
+    static void store(double *p, const V &a) { _mm256_storeu_pd(p, a); }
+    static V add(const V &a, const V &b) { return _mm256_add_pd(a, b); }
+    static V sub(const V &a, const V &b) { return _mm256_sub_pd(a, b); }
+    static V mul(const V &a, const V &b) { return _mm256_mul_pd(a, b); }
+    static V div(const V &a, const V &b) { return _mm256_div_pd(a, b); }
+    static V sqrt(const V &a) { return _mm256_sqrt_pd(a); }
+    static V neg(const V &a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.)); }
+    static V abs(const V &a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.), a); }
+    static V lt(const V &a, const V &b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static V le(const V &a, const V &b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static V gt(const V &a, const V &b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static V ge(const V &a, const V &b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static V eq(const V &a, const V &b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static V band(const V &a, const V &b) { return _mm256_and_pd(a, b); }
+    static V bor(const V &a, const V &b) { return _mm256_or_pd(a, b); }
+    static V select(const V &m, const V &a, const V &b) { return _mm256_blendv_pd(b, a, m); }
+    static int bits(const V &m) { return _mm256_movemask_pd(m); }
+};
+
+const EdgeKernels * edgeKernelsAVX2() {
+    static const EdgeKernels kernels = {
+        "AVX2",
+        &EdgeKernelsImpl<AVX2Lanes>::linearSignedDistance,
+        &EdgeKernelsImpl<AVX2Lanes>::quadraticSignedDistance
+    };
+    return &kernels;
+}
+
+#else
+
+const EdgeKernels * edgeKernelsAVX2() {
+    return NULL;
+}
+
+#endif
+
+}
@@ -0,0 +1,154 @@
+
+#include "edge-kernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MSDFGEN_SSE2_KERNELS
+    #include <emmintrin.h>
+    #include "edge-kernels.hpp"
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+namespace msdfgen {
+
+#ifdef MSDFGEN_SSE2_KERNELS
+
+/// Four lanes emulated by a pair of SSE2 registers.
+struct SSE2Lanes {
+    typedef double Scalar;
+    struct V {
+        __m128d lo, hi;
+    };
+
+    static V make(__m128d lo, __m128d hi) {
+        V v = { lo, hi };
+        return v;
+    }
+    static V set1(double x) { return make(_mm_set1_pd(x), _mm_set1_pd(x)); }
+    static V load(const double *p) { return make(_mm_loadu_pd(p), _mm_loadu_pd(p+2)); }
+    static void store(double *p, const V &a) { _mm_storeu_pd(p, a.lo), _mm_storeu_pd(p+2, a.hi); }
+    static V add(const V &a, const V &b) { return make(_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)); }
+    static V sub(const V &a, const V &b) { return make(_mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi)); }
+    static V mul(const V &a, const V &b) { return make(_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)); }
+    static V div(const V &a, const V &b) { return make(_mm_div_pd(a.lo, b.lo), _mm_div_pd(a.hi, b.hi)); }
+    static V sqrt(const V &a) { return make(_mm_sqrt_pd(a.lo), _mm_sqrt_pd(a.hi)); }
+    static V neg(const V &a) { __m128d s = _mm_set1_pd(-0.); return make(_mm_xor_pd(a.lo, s), _mm_xor_pd(a.hi, s)); }
+    static V abs(const V &a) { __m128d s = _mm_set1_pd(-0.); return make(_mm_andnot_pd(s, a.lo), _mm_andnot_pd(s, a.hi)); }
+    static V lt(const V &a, const V &b) { return make(_mm_cmplt_pd(a.lo, b.lo), _mm_cmplt_pd(a.hi, b.hi)); }
+    static V le(const V &a, const V &b) { return make(_mm_cmple_pd(a.lo, b.lo), _mm_cmple_pd(a.hi, b.hi)); }
+    static V gt(const V &a, const V &b) { return make(_mm_cmpgt_pd(a.lo, b.lo), _mm_cmpgt_pd(a.hi, b.hi)); }
+    static V ge(const V &a, const V &b) { return make(_mm_cmpge_pd(a.lo, b.lo), _mm_cmpge_pd(a.hi, b.hi)); }
+    static V eq(const V &a, const V &b) { return make(_mm_cmpeq_pd(a.lo, b.lo), _mm_cmpeq_pd(a.hi, b.hi)); }
+    static V band(const V &a, const V &b) { return make(_mm_and_pd(a.lo, b.lo), _mm_and_pd(a.hi, b.hi)); }
+    static V bor(const V &a, const V &b) { return make(_mm_or_pd(a.lo, b.lo), _mm_or_pd(a.hi, b.hi)); }
+    static V select(const V &m, const V &a, const V &b) {
+        return make(_mm_or_pd(_mm_and_pd(m.lo, a.lo), _mm_andnot_pd(m.lo, b.lo)), _mm_or_pd(_mm_and_pd(m.hi, a.hi), _mm_andnot_pd(m.hi, b.hi)));
+    }
+    static int bits(const V &m) { return _mm_movemask_pd(m.lo)|_mm_movemask_pd(m.hi)<<2; }
+};
+
+/// Four single-precision lanes in one SSE register.
+struct SSEFloatLanes {
+    typedef float Scalar;
+    typedef __m128 V;
+
+    static V set1(double x) { return _mm_set1_ps(float(x)); }
+    static V load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, const V &a) { _mm_storeu_ps(p, a); }
+    static V add(const V &a, const V &b) { return _mm_add_ps(a, b); }
+    static V sub(const V &a, const V &b) { return _mm_sub_ps(a, b); }
+    static V mul(const V &a, const V &b) { return _mm_mul_ps(a, b); }
+    static V div(const V &a, const V &b) { return _mm_div_ps(a, b); }
+    static V sqrt(const V &a) { return _mm_sqrt_ps(a); }
+    static V neg(const V &a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+    static V abs(const V &a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    static V lt(const V &a, const V &b) { return _mm_cmplt_ps(a, b); }
+    static V le(const V &a, const V &b) { return _mm_cmple_ps(a, b); }
+    static V gt(const V &a, const V &b) { return _mm_cmpgt_ps(a, b); }
+    static V ge(const V &a, const V &b) { return _mm_cmpge_ps(a, b); }
+    static V eq(const V &a, const V &b) { return _mm_cmpeq_ps(a, b); }
+    static V band(const V &a, const V &b) { return _mm_and_ps(a, b); }
+    static V bor(const V &a, const V &b) { return _mm_or_ps(a, b); }
+    static V select(const V &m, const V &a, const V &b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static int bits(const V &m) { return _mm_movemask_ps(m); }
+};
+
+const EdgeKernels * edgeKernelsSSE2() {
+    static const EdgeKernels kernels = {
+        "SSE2",
+        &EdgeKernelsImpl<SSE2Lanes>::linearSignedDistance,
+        &EdgeKernelsImpl<SSE2Lanes>::quadraticSignedDistance
+    };
+    return &kernels;
+}
+
+const EdgeKernels * edgeKernelsSSEFloat() {
+    static const EdgeKernels kernels = {
+        "SSE float",
+        &EdgeKernelsImpl<SSEFloatLanes>::linearSignedDistance,
+        &EdgeKernelsImpl<SSEFloatLanes>::quadraticSignedDistance
+    };
+    return &kernels;
+}
+
+#else
+
+const EdgeKernels * edgeKernelsSSE2() {
+    return NULL;
+}
+
+const EdgeKernels * edgeKernelsSSEFloat() {
+    return NULL;
+}
+
+#endif
+
+static bool noLinearKernel(const Point2 [2], const LinearSegmentTerms &, const double *, const double *, SignedDistance *, double *) {
+    return false;
+}
+
+static bool noQuadraticKernel(const Point2 [3], const QuadraticSegmentTerms &, const double *, const double *, SignedDistance *, double *) {
+    return false;
+}
+
+static bool cpuSupportsAVX2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    // The OS must save the YMM registers on context switch (OSXSAVE and AVX, then XCR0 bits 1 and 2)
+    if ((info[2]&0x18000000) != 0x18000000 || (_xgetbv(0)&0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1]&0x20) != 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+static const EdgeKernels * selectEdgeKernels() {
+    static const EdgeKernels scalar = { "scalar", &noLinearKernel, &noQuadraticKernel };
+    const EdgeKernels *kernels = NULL;
+#ifdef MSDFGEN_FLOAT_KERNELS
+    kernels = edgeKernelsSSEFloat();
+#endif
+    if (!kernels && cpuSupportsAVX2())
+        kernels = edgeKernelsAVX2();
+    if (!kernels)
+        kernels = edgeKernelsSSE2();
+    return kernels ? kernels : &scalar;
+}
+
+const EdgeKernels & edgeKernels() {
+    static const EdgeKernels *kernels = selectEdgeKernels();
+    return *kernels;
+}
+
+}
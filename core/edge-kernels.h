@@ -0,0 +1,30 @@
+
+#pragma once
+
+#include "Vector2.h"
+#include "SignedDistance.h"
+#include "edge-segments.h"
+
+namespace msdfgen {
+
+// Number of points processed at once by batched signed distance queries.
+#define MSDFGEN_DISTANCE_BATCH 4
+
+/// Batched signed distance kernels. Each function evaluates MSDFGEN_DISTANCE_BATCH points at once and returns false if no vectorized implementation is available.
+struct EdgeKernels {
+    const char *name;
+    bool (*linearSignedDistance)(const Point2 p[2], const LinearSegmentTerms &terms, const double *x, const double *y, SignedDistance *distances, double *params);
+    bool (*quadraticSignedDistance)(const Point2 p[3], const QuadraticSegmentTerms &terms, const double *x, const double *y, SignedDistance *distances, double *params);
+};
+
+/// Returns the kernels for the best instruction set supported by the CPU, selected on first use.
+const EdgeKernels & edgeKernels();
+
+/// Kernels of individual instruction sets, or NULL if not compiled in.
+const EdgeKernels * edgeKernelsSSE2();
+const EdgeKernels * edgeKernelsAVX2();
+/// Single-precision kernels, which are faster but less accurate. They are only selected by edgeKernels if MSDFGEN_FLOAT_KERNELS is defined.
+/// Besides the small deviation of the distances, they may resolve near ties between edges differently, which affects the pseudo-distances.
+const EdgeKernels * edgeKernelsSSEFloat();
+
+}
@@ -0,0 +1,203 @@
+
+#pragma once
+
+/*
+ * Instruction set and precision independent implementation of the batched signed distance kernels.
+ * With double-precision lanes, each kernel performs exactly the same sequence of floating-point operations as the scalar
+ * LinearSegment::signedDistance and QuadraticSegment::signedDistance, lane by lane, so that the results
+ * are bit-identical. Only the transcendental functions in the trigonometric and Cardano branches of the
+ * cubic solver are evaluated per lane by the standard library for the same reason.
+ * Single-precision lanes perform the same operations in float, which fits twice as many lanes in a register.
+ *
+ * The lane type L must provide the scalar type L::Scalar, a vector type L::V of MSDFGEN_DISTANCE_BATCH scalars and the
+ * static functions set1 (of a double), load, store, add, sub, mul, div, sqrt, neg, abs, lt, le, gt, ge, eq, band, bor,
+ * select (mask ? a : b) and bits, which returns the comparison mask as an integer with one bit per lane.
+ */
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include "edge-kernels.h"
+
+namespace msdfgen {
+
+template <class L>
+class EdgeKernelsImpl {
+
+    typedef typename L::Scalar S;
+    typedef typename L::V V;
+
+    static V loadCoordinates(const double *coordinates) {
+        S c[MSDFGEN_DISTANCE_BATCH];
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i)
+            c[i] = S(coordinates[i]);
+        return L::load(c);
+    }
+
+    static void storeResult(const V &distance, const V &dot, const V &param, SignedDistance *distances, double *params) {
+        S d[MSDFGEN_DISTANCE_BATCH], o[MSDFGEN_DISTANCE_BATCH], t[MSDFGEN_DISTANCE_BATCH];
+        L::store(d, distance);
+        L::store(o, dot);
+        L::store(t, param);
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i) {
+            distances[i] = SignedDistance(d[i], o[i]);
+            params[i] = t[i];
+        }
+    }
+
+    /// Equivalent of nonZeroSign(n)*value.
+    static V applySign(const V &n, const V &value) {
+        return L::select(L::gt(n, L::set1(0)), value, L::neg(value));
+    }
+
+    /// Equivalent of fabs(dotProduct(dir, Vector2(x, y).normalize())) with len = Vector2(x, y).length().
+    static V normalizedDot(const Vector2 &dir, const V &x, const V &y, const V &len) {
+        V zero = L::eq(len, L::set1(0));
+        V nx = L::select(zero, L::set1(0), L::div(x, len));
+        V ny = L::select(zero, L::set1(1), L::div(y, len));
+        return L::abs(L::add(L::mul(L::set1(dir.x), nx), L::mul(L::set1(dir.y), ny)));
+    }
+
+    static V length(const V &x, const V &y) {
+        return L::sqrt(L::add(L::mul(x, x), L::mul(y, y)));
+    }
+
+public:
+    static bool linearSignedDistance(const Point2 p[2], const LinearSegmentTerms &terms, const double *x, const double *y, SignedDistance *distances, double *params) {
+        const Vector2 &ab = terms.ab, &orthonormal = terms.orthonormal;
+        V ox = loadCoordinates(x), oy = loadCoordinates(y);
+        V aqx = L::sub(ox, L::set1(p[0].x)), aqy = L::sub(oy, L::set1(p[0].y));
+        V param = L::div(L::add(L::mul(aqx, L::set1(ab.x)), L::mul(aqy, L::set1(ab.y))), L::set1(terms.abab));
+        V second = L::gt(param, L::set1(.5));
+        V eqx = L::sub(L::select(second, L::set1(p[1].x), L::set1(p[0].x)), ox);
+        V eqy = L::sub(L::select(second, L::set1(p[1].y), L::set1(p[0].y)), oy);
+        V endpointDistance = length(eqx, eqy);
+        V orthoDistance = L::add(L::mul(L::set1(orthonormal.x), aqx), L::mul(L::set1(orthonormal.y), aqy));
+        V ortho = L::band(L::band(L::gt(param, L::set1(0)), L::lt(param, L::set1(1))), L::lt(L::abs(orthoDistance), endpointDistance));
+        V cross = L::sub(L::mul(aqx, L::set1(ab.y)), L::mul(aqy, L::set1(ab.x)));
+        V distance = L::select(ortho, orthoDistance, applySign(cross, endpointDistance));
+        V dot = L::select(ortho, L::set1(0), normalizedDot(terms.direction, eqx, eqy, endpointDistance));
+        storeResult(distance, dot, param, distances, params);
+        return true;
+    }
+
+    static bool quadraticSignedDistance(const Point2 p[3], const QuadraticSegmentTerms &terms, const double *x, const double *y, SignedDistance *distances, double *params) {
+        const Vector2 &ab = terms.ab, &br = terms.br, &bc = terms.bc, &ac = terms.ac;
+        double a = terms.a, b = terms.b, abab = terms.abab;
+        V ox = loadCoordinates(x), oy = loadCoordinates(y);
+        V qax = L::sub(L::set1(p[0].x), ox), qay = L::sub(L::set1(p[0].y), oy);
+        V c = L::add(L::set1(2*abab), L::add(L::mul(qax, L::set1(br.x)), L::mul(qay, L::set1(br.y))));
+        V d = L::add(L::mul(qax, L::set1(ab.x)), L::mul(qay, L::set1(ab.y)));
+
+        // solveCubic(t, a, b, c, d)
+        V t[3], valid[3];
+        V none = L::set1(0), all = L::eq(none, none);
+        if (fabs(a) < 1e-14) {
+            // solveQuadratic(t, b, c, d)
+            valid[2] = none;
+            if (fabs(b) < 1e-14) {
+                t[0] = L::div(L::neg(d), c);
+                valid[0] = L::ge(L::abs(c), L::set1(1e-14));
+                t[1] = t[0];
+                valid[1] = none;
+            } else {
+                V dscr = L::sub(L::mul(c, c), L::mul(L::set1(4*b), d));
+                V sqrtDscr = L::sqrt(dscr);
+                V positive = L::gt(dscr, L::set1(0));
+                V negC = L::neg(c);
+                t[0] = L::select(positive, L::div(L::add(negC, sqrtDscr), L::set1(2*b)), L::div(negC, L::set1(2*b)));
+                t[1] = L::div(L::sub(negC, sqrtDscr), L::set1(2*b));
+                valid[0] = L::ge(dscr, L::set1(0));
+                valid[1] = positive;
+            }
+            t[2] = t[0];
+        } else {
+            // solveCubicNormed(t, b/a, c/a, d/a)
+            double na = b/a;
+            V nb = L::div(c, L::set1(a)), nc = L::div(d, L::set1(a));
+            double a2 = na*na;
+            V q = L::div(L::sub(L::set1(a2), L::mul(L::set1(3), nb)), L::set1(9));
+            V r = L::div(L::add(L::mul(L::set1(na), L::sub(L::set1(2*a2), L::mul(L::set1(9), nb))), L::mul(L::set1(27), nc)), L::set1(54));
+            V r2 = L::mul(r, r);
+            V q3 = L::mul(L::mul(q, q), q);
+            V trig = L::lt(r2, q3);
+            // Trigonometric branch arguments
+            V u = L::div(r, L::sqrt(q3));
+            u = L::select(L::lt(u, L::set1(-1)), L::set1(-1), u);
+            u = L::select(L::gt(u, L::set1(1)), L::set1(1), u);
+            // Cardano branch argument
+            V s = L::add(L::abs(r), L::sqrt(L::sub(r2, q3)));
+            S lu[MSDFGEN_DISTANCE_BATCH], ls[MSDFGEN_DISTANCE_BATCH], lr[MSDFGEN_DISTANCE_BATCH], lq[MSDFGEN_DISTANCE_BATCH];
+            S c0[MSDFGEN_DISTANCE_BATCH], c1[MSDFGEN_DISTANCE_BATCH], c2[MSDFGEN_DISTANCE_BATCH];
+            L::store(lu, u);
+            L::store(ls, s);
+            L::store(lr, r);
+            L::store(lq, q);
+            int trigLanes = L::bits(trig);
+            for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i) {
+                if (trigLanes>>i&1) {
+                    double angle = acos(double(lu[i]));
+                    c0[i] = S(cos(angle/3));
+                    c1[i] = S(cos((angle+2*M_PI)/3));
+                    c2[i] = S(cos((angle-2*M_PI)/3));
+                } else {
+                    double A = -pow(double(ls[i]), 1/3.);
+                    if (lr[i] < 0) A = -A;
+                    // A and B of Cardano's formula are passed through the cosine slots
+                    c0[i] = S(A);
+                    c1[i] = S(A == 0 ? 0 : lq[i]/A);
+                    c2[i] = 0;
+                }
+            }
+            V a3 = L::set1(na/3);
+            V cos0 = L::load(c0), cos1 = L::load(c1), cos2 = L::load(c2);
+            V m = L::mul(L::set1(-2), L::sqrt(q));
+            V sum = L::add(cos0, cos1);
+            V im = L::mul(L::set1(0.5*sqrt(3.)), L::sub(cos0, cos1));
+            t[0] = L::select(trig, L::sub(L::mul(m, cos0), a3), L::sub(sum, a3));
+            t[1] = L::select(trig, L::sub(L::mul(m, cos1), a3), L::sub(L::mul(L::set1(-0.5), sum), a3));
+            t[2] = L::sub(L::mul(m, cos2), a3);
+            valid[0] = all;
+            valid[1] = L::bor(trig, L::lt(L::abs(im), L::set1(1e-14)));
+            valid[2] = trig;
+        }
+
+        V minDistance = applySign(L::sub(L::mul(L::set1(ab.x), qay), L::mul(L::set1(ab.y), qax)), length(qax, qay));
+        V param = L::div(L::neg(d), L::set1(abab));
+        {
+            V bqx = L::sub(L::set1(p[2].x), ox), bqy = L::sub(L::set1(p[2].y), oy);
+            V distance = applySign(L::sub(L::mul(L::set1(bc.x), bqy), L::mul(L::set1(bc.y), bqx)), length(bqx, bqy));
+            V closer = L::lt(L::abs(distance), L::abs(minDistance));
+            if (L::bits(closer)) {
+                V bParam = L::div(L::add(L::mul(L::sub(ox, L::set1(p[1].x)), L::set1(bc.x)), L::mul(L::sub(oy, L::set1(p[1].y)), L::set1(bc.y))), L::set1(terms.bcbc));
+                minDistance = L::select(closer, distance, minDistance);
+                param = L::select(closer, bParam, param);
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            V candidate = L::band(valid[i], L::band(L::gt(t[i], L::set1(0)), L::lt(t[i], L::set1(1))));
+            if (!L::bits(candidate))
+                continue;
+            V ex = L::add(L::add(L::set1(p[0].x), L::mul(L::mul(L::set1(2), t[i]), L::set1(ab.x))), L::mul(L::mul(t[i], t[i]), L::set1(br.x)));
+            V ey = L::add(L::add(L::set1(p[0].y), L::mul(L::mul(L::set1(2), t[i]), L::set1(ab.y))), L::mul(L::mul(t[i], t[i]), L::set1(br.y)));
+            V eox = L::sub(ex, ox), eoy = L::sub(ey, oy);
+            V distance = applySign(L::sub(L::mul(L::set1(ac.x), eoy), L::mul(L::set1(ac.y), eox)), length(eox, eoy));
+            V closer = L::band(candidate, L::le(L::abs(distance), L::abs(minDistance)));
+            minDistance = L::select(closer, distance, minDistance);
+            param = L::select(closer, t[i], param);
+        }
+
+        V inside = L::band(L::ge(param, L::set1(0)), L::le(param, L::set1(1)));
+        V dot = L::set1(0);
+        if (L::bits(inside) != (1<<MSDFGEN_DISTANCE_BATCH)-1) {
+            V bqx = L::sub(L::set1(p[2].x), ox), bqy = L::sub(L::set1(p[2].y), oy);
+            V dotA = normalizedDot(terms.startDirection, qax, qay, length(qax, qay));
+            V dotB = normalizedDot(terms.endDirection, bqx, bqy, length(bqx, bqy));
+            dot = L::select(inside, dot, L::select(L::lt(param, L::set1(.5)), dotA, dotB));
+        }
+        storeResult(minDistance, dot, param, distances, params);
+        return true;
+    }
+
+};
+
+}
@@ -1,6 +1,7 @@
 
 #include "edge-segments.h"
 
+#include "EdgeHolder.h"
 #include "arithmetics.hpp"
 #include "equation-solver.h"
 
@@ -72,11 +73,15 @@ Point2 QuadraticSegment::point(double param) const {
     return mix(mix(p[0], p[1], param), mix(p[1], p[2], param), param);
 }
 
-Point2 CubicSegment::point(double param) const {
+static Point2 cubicPoint(const Point2 p[4], double param) {
     Vector2 p12 = mix(p[1], p[2], param);
     return mix(mix(mix(p[0], p[1], param), p12, param), mix(p12, mix(p[2], p[3], param), param), param);
 }
 
+Point2 CubicSegment::point(double param) const {
+    return cubicPoint(p, param);
+}
+
 Vector2 LinearSegment::direction(double param) const {
     return p[1]-p[0];
 }
@@ -85,7 +90,7 @@ Vector2 QuadraticSegment::direction(double param) const {
     return mix(p[1]-p[0], p[2]-p[1], param);
 }
 
-Vector2 CubicSegment::direction(double param) const {
+static Vector2 cubicDirection(const Point2 p[4], double param) {
     Vector2 tangent = mix(mix(p[1]-p[0], p[2]-p[1], param), mix(p[2]-p[1], p[3]-p[2], param), param);
     if (!tangent) {
         if (param == 0) return p[2]-p[0];
@@ -94,44 +99,105 @@ Vector2 CubicSegment::direction(double param) const {
     return tangent;
 }
 
-SignedDistance LinearSegment::signedDistance(Point2 origin, double &param) const {
+Vector2 CubicSegment::direction(double param) const {
+    return cubicDirection(p, param);
+}
+
+void prepareLinearSegment(const Point2 p[2], LinearSegmentTerms &terms) {
+    terms.ab = p[1]-p[0];
+    terms.orthonormal = terms.ab.getOrthonormal(false);
+    terms.direction = terms.ab.normalize();
+    terms.abab = dotProduct(terms.ab, terms.ab);
+}
+
+void prepareQuadraticSegment(const Point2 p[3], QuadraticSegmentTerms &terms) {
+    terms.ab = p[1]-p[0];
+    terms.br = p[0]+p[2]-p[1]-p[1];
+    terms.bc = p[2]-p[1];
+    terms.ac = p[2]-p[0];
+    terms.startDirection = terms.ab.normalize();
+    terms.endDirection = terms.bc.normalize();
+    terms.a = dotProduct(terms.br, terms.br);
+    terms.b = 3*dotProduct(terms.ab, terms.br);
+    terms.abab = dotProduct(terms.ab, terms.ab);
+    terms.bcbc = dotProduct(terms.bc, terms.bc);
+}
+
+void prepareCubicSegment(const Point2 p[4], CubicSegmentTerms &terms) {
+    terms.ab = p[1]-p[0];
+    terms.br = p[2]-p[1]-terms.ab;
+    terms.as = (p[3]-p[2])-(p[2]-p[1])-terms.br;
+    terms.startTangent = cubicDirection(p, 0);
+    terms.endTangent = cubicDirection(p, 1);
+    terms.startTangentSquared = dotProduct(terms.startTangent, terms.startTangent);
+    terms.endTangentSquared = dotProduct(terms.endTangent, terms.endTangent);
+    terms.startDirection = terms.startTangent.normalize();
+    terms.endDirection = terms.endTangent.normalize();
+    // dot(P(t)-origin, P'(t))/3, where P(t) = p[0]+3*t*ab+3*t*t*br+t*t*t*as
+    terms.a = dotProduct(terms.as, terms.as);
+    terms.b = 5*dotProduct(terms.as, terms.br);
+    terms.c = 4*dotProduct(terms.as, terms.ab)+6*dotProduct(terms.br, terms.br);
+    terms.d = 9*dotProduct(terms.ab, terms.br);
+    terms.e = 3*dotProduct(terms.ab, terms.ab);
+    terms.boundsLo = p[0], terms.boundsHi = p[0];
+    for (int i = 1; i < 4; ++i) {
+        terms.boundsLo.x = min(terms.boundsLo.x, p[i].x), terms.boundsLo.y = min(terms.boundsLo.y, p[i].y);
+        terms.boundsHi.x = max(terms.boundsHi.x, p[i].x), terms.boundsHi.y = max(terms.boundsHi.y, p[i].y);
+    }
+}
+
+SignedDistance linearSignedDistance(const Point2 p[2], Point2 origin, double &param) {
+    LinearSegmentTerms terms;
+    prepareLinearSegment(p, terms);
+    return linearSignedDistance(p, terms, origin, param);
+}
+
+SignedDistance quadraticSignedDistance(const Point2 p[3], Point2 origin, double &param) {
+    QuadraticSegmentTerms terms;
+    prepareQuadraticSegment(p, terms);
+    return quadraticSignedDistance(p, terms, origin, param);
+}
+
+SignedDistance cubicSignedDistance(const Point2 p[4], Point2 origin, double &param) {
+    CubicSegmentTerms terms;
+    prepareCubicSegment(p, terms);
+    return cubicSignedDistance(p, terms, origin, param);
+}
+
+SignedDistance linearSignedDistance(const Point2 p[2], const LinearSegmentTerms &terms, Point2 origin, double &param) {
     Vector2 aq = origin-p[0];
-    Vector2 ab = p[1]-p[0];
-    param = dotProduct(aq, ab)/dotProduct(ab, ab);
+    param = dotProduct(aq, terms.ab)/terms.abab;
     Vector2 eq = p[param > .5]-origin;
     double endpointDistance = eq.length();
     if (param > 0 && param < 1) {
-        double orthoDistance = dotProduct(ab.getOrthonormal(false), aq);
+        double orthoDistance = dotProduct(terms.orthonormal, aq);
         if (fabs(orthoDistance) < endpointDistance)
             return SignedDistance(orthoDistance, 0);
     }
-    return SignedDistance(nonZeroSign(crossProduct(aq, ab))*endpointDistance, fabs(dotProduct(ab.normalize(), eq.normalize())));
+    return SignedDistance(nonZeroSign(crossProduct(aq, terms.ab))*endpointDistance, fabs(dotProduct(terms.direction, eq.normalize())));
 }
 
-SignedDistance QuadraticSegment::signedDistance(Point2 origin, double &param) const {
+SignedDistance quadraticSignedDistance(const Point2 p[3], const QuadraticSegmentTerms &terms, Point2 origin, double &param) {
+    const Vector2 &ab = terms.ab, &br = terms.br;
     Vector2 qa = p[0]-origin;
-    Vector2 ab = p[1]-p[0];
-    Vector2 br = p[0]+p[2]-p[1]-p[1];
-    double a = dotProduct(br, br);
-    double b = 3*dotProduct(ab, br);
-    double c = 2*dotProduct(ab, ab)+dotProduct(qa, br);
+    double c = 2*terms.abab+dotProduct(qa, br);
     double d = dotProduct(qa, ab);
     double t[3];
-    int solutions = solveCubic(t, a, b, c, d);
+    int solutions = solveCubic(t, terms.a, terms.b, c, d);
 
     double minDistance = nonZeroSign(crossProduct(ab, qa))*qa.length(); // distance from A
-    param = -dotProduct(qa, ab)/dotProduct(ab, ab);
+    param = -dotProduct(qa, ab)/terms.abab;
     {
-        double distance = nonZeroSign(crossProduct(p[2]-p[1], p[2]-origin))*(p[2]-origin).length(); // distance from B
+        double distance = nonZeroSign(crossProduct(terms.bc, p[2]-origin))*(p[2]-origin).length(); // distance from B
         if (fabs(distance) < fabs(minDistance)) {
             minDistance = distance;
-            param = dotProduct(origin-p[1], p[2]-p[1])/dotProduct(p[2]-p[1], p[2]-p[1]);
+            param = dotProduct(origin-p[1], terms.bc)/terms.bcbc;
         }
     }
     for (int i = 0; i < solutions; ++i) {
         if (t[i] > 0 && t[i] < 1) {
             Point2 endpoint = p[0]+2*t[i]*ab+t[i]*t[i]*br;
-            double distance = nonZeroSign(crossProduct(p[2]-p[0], endpoint-origin))*(endpoint-origin).length();
+            double distance = nonZeroSign(crossProduct(terms.ac, endpoint-origin))*(endpoint-origin).length();
             if (fabs(distance) <= fabs(minDistance)) {
                 minDistance = distance;
                 param = t[i];
@@ -142,55 +208,62 @@ SignedDistance QuadraticSegment::signedDistance(Point2 origin, double &param) co
     if (param >= 0 && param <= 1)
         return SignedDistance(minDistance, 0);
     if (param < .5)
-        return SignedDistance(minDistance, fabs(dotProduct(ab.normalize(), qa.normalize())));
+        return SignedDistance(minDistance, fabs(dotProduct(terms.startDirection, qa.normalize())));
     else
-        return SignedDistance(minDistance, fabs(dotProduct((p[2]-p[1]).normalize(), (p[2]-origin).normalize())));
+        return SignedDistance(minDistance, fabs(dotProduct(terms.endDirection, (p[2]-origin).normalize())));
 }
 
-SignedDistance CubicSegment::signedDistance(Point2 origin, double &param) const {
+SignedDistance cubicSignedDistance(const Point2 p[4], const CubicSegmentTerms &terms, Point2 origin, double &param) {
+    const Vector2 &ab = terms.ab, &br = terms.br, &as = terms.as;
     Vector2 qa = p[0]-origin;
-    Vector2 ab = p[1]-p[0];
-    Vector2 br = p[2]-p[1]-ab;
-    Vector2 as = (p[3]-p[2])-(p[2]-p[1])-br;
 
-    Vector2 epDir = direction(0);
-    double minDistance = nonZeroSign(crossProduct(epDir, qa))*qa.length(); // distance from A
-    param = -dotProduct(qa, epDir)/dotProduct(epDir, epDir);
+    double minDistance = nonZeroSign(crossProduct(terms.startTangent, qa))*qa.length(); // distance from A
+    param = -dotProduct(qa, terms.startTangent)/terms.startTangentSquared;
     {
-        epDir = direction(1);
+        const Vector2 &epDir = terms.endTangent;
         double distance = nonZeroSign(crossProduct(epDir, p[3]-origin))*(p[3]-origin).length(); // distance from B
         if (fabs(distance) < fabs(minDistance)) {
             minDistance = distance;
-            param = dotProduct(origin+epDir-p[3], epDir)/dotProduct(epDir, epDir);
+            param = dotProduct(origin+epDir-p[3], epDir)/terms.endTangentSquared;
         }
     }
-    // Iterative minimum distance search
-    for (int i = 0; i <= MSDFGEN_CUBIC_SEARCH_STARTS; ++i) {
-        double t = (double) i/MSDFGEN_CUBIC_SEARCH_STARTS;
-        for (int step = 0;; ++step) {
-            Vector2 qpt = point(t)-origin;
-            double distance = nonZeroSign(crossProduct(direction(t), qpt))*qpt.length();
-            if (fabs(distance) < fabs(minDistance)) {
-                minDistance = distance;
-                param = t;
+    // An inner point can only be nearer than the endpoints if the bounding box of the control points is nearer to the origin than the nearest endpoint
+    double boxX = max(max(terms.boundsLo.x-origin.x, origin.x-terms.boundsHi.x), 0.);
+    double boxY = max(max(terms.boundsLo.y-origin.y, origin.y-terms.boundsHi.y), 0.);
+    if (boxX*boxX+boxY*boxY < minDistance*minDistance) {
+        // The nearest inner point is a root of the derivative of the squared distance
+        double t[5];
+        int solutions = solveQuintic(t, terms.a, terms.b, terms.c, terms.d+dotProduct(qa, as), terms.e+2*dotProduct(qa, br), dotProduct(qa, ab), 0, 1);
+        for (int i = 0; i < solutions; ++i) {
+            if (t[i] > 0 && t[i] < 1) {
+                Vector2 qpt = cubicPoint(p, t[i])-origin;
+                double distance = nonZeroSign(crossProduct(cubicDirection(p, t[i]), qpt))*qpt.length();
+                if (fabs(distance) <= fabs(minDistance)) {
+                    minDistance = distance;
+                    param = t[i];
+                }
             }
-            if (step == MSDFGEN_CUBIC_SEARCH_STEPS)
-                break;
-            // Improve t
-            Vector2 d1 = 3*as*t*t+6*br*t+3*ab;
-            Vector2 d2 = 6*as*t+6*br;
-            t -= dotProduct(qpt, d1)/(dotProduct(d1, d1)+dotProduct(qpt, d2));
-            if (t < 0 || t > 1)
-                break;
         }
     }
 
     if (param >= 0 && param <= 1)
         return SignedDistance(minDistance, 0);
     if (param < .5)
-        return SignedDistance(minDistance, fabs(dotProduct(direction(0).normalize(), qa.normalize())));
+        return SignedDistance(minDistance, fabs(dotProduct(terms.startDirection, qa.normalize())));
     else
-        return SignedDistance(minDistance, fabs(dotProduct(direction(1).normalize(), (p[3]-origin).normalize())));
+        return SignedDistance(minDistance, fabs(dotProduct(terms.endDirection, (p[3]-origin).normalize())));
+}
+
+SignedDistance LinearSegment::signedDistance(Point2 origin, double &param) const {
+    return linearSignedDistance(p, origin, param);
+}
+
+SignedDistance QuadraticSegment::signedDistance(Point2 origin, double &param) const {
+    return quadraticSignedDistance(p, origin, param);
+}
+
+SignedDistance CubicSegment::signedDistance(Point2 origin, double &param) const {
+    return cubicSignedDistance(p, origin, param);
 }
 
 static void pointBounds(Point2 p, double &l, double &b, double &r, double &t) {
@@ -275,25 +348,99 @@ void CubicSegment::moveEndPoint(Point2 to) {
     p[3] = to;
 }
 
-void LinearSegment::splitInThirds(EdgeSegment *&part1, EdgeSegment *&part2, EdgeSegment *&part3) const {
-    part1 = new LinearSegment(p[0], point(1/3.), color);
-    part2 = new LinearSegment(point(1/3.), point(2/3.), color);
-    part3 = new LinearSegment(point(2/3.), p[1], color);
+void LinearSegment::splitInThirds(EdgeHolder &part1, EdgeHolder &part2, EdgeHolder &part3) const {
+    part1 = EdgeHolder(p[0], point(1/3.), color);
+    part2 = EdgeHolder(point(1/3.), point(2/3.), color);
+    part3 = EdgeHolder(point(2/3.), p[1], color);
 }
 
-void QuadraticSegment::splitInThirds(EdgeSegment *&part1, EdgeSegment *&part2, EdgeSegment *&part3) const {
-    part1 = new QuadraticSegment(p[0], mix(p[0], p[1], 1/3.), point(1/3.), color);
-    part2 = new QuadraticSegment(point(1/3.), mix(mix(p[0], p[1], 5/9.), mix(p[1], p[2], 4/9.), .5), point(2/3.), color);
-    part3 = new QuadraticSegment(point(2/3.), mix(p[1], p[2], 2/3.), p[2], color);
+void QuadraticSegment::splitInThirds(EdgeHolder &part1, EdgeHolder &part2, EdgeHolder &part3) const {
+    part1 = EdgeHolder(p[0], mix(p[0], p[1], 1/3.), point(1/3.), color);
+    part2 = EdgeHolder(point(1/3.), mix(mix(p[0], p[1], 5/9.), mix(p[1], p[2], 4/9.), .5), point(2/3.), color);
+    part3 = EdgeHolder(point(2/3.), mix(p[1], p[2], 2/3.), p[2], color);
 }
 
-void CubicSegment::splitInThirds(EdgeSegment *&part1, EdgeSegment *&part2, EdgeSegment *&part3) const {
-    part1 = new CubicSegment(p[0], p[0] == p[1] ? p[0] : mix(p[0], p[1], 1/3.), mix(mix(p[0], p[1], 1/3.), mix(p[1], p[2], 1/3.), 1/3.), point(1/3.), color);
-    part2 = new CubicSegment(point(1/3.),
+void CubicSegment::splitInThirds(EdgeHolder &part1, EdgeHolder &part2, EdgeHolder &part3) const {
+    part1 = EdgeHolder(p[0], p[0] == p[1] ? p[0] : mix(p[0], p[1], 1/3.), mix(mix(p[0], p[1], 1/3.), mix(p[1], p[2], 1/3.), 1/3.), point(1/3.), color);
+    part2 = EdgeHolder(point(1/3.),
         mix(mix(mix(p[0], p[1], 1/3.), mix(p[1], p[2], 1/3.), 1/3.), mix(mix(p[1], p[2], 1/3.), mix(p[2], p[3], 1/3.), 1/3.), 2/3.),
         mix(mix(mix(p[0], p[1], 2/3.), mix(p[1], p[2], 2/3.), 2/3.), mix(mix(p[1], p[2], 2/3.), mix(p[2], p[3], 2/3.), 2/3.), 1/3.),
         point(2/3.), color);
-    part3 = new CubicSegment(point(2/3.), mix(mix(p[1], p[2], 2/3.), mix(p[2], p[3], 2/3.), 2/3.), p[2] == p[3] ? p[3] : mix(p[2], p[3], 2/3.), p[3], color);
+    part3 = EdgeHolder(point(2/3.), mix(mix(p[1], p[2], 2/3.), mix(p[2], p[3], 2/3.), 2/3.), p[2] == p[3] ? p[3] : mix(p[2], p[3], 2/3.), p[3], color);
+}
+
+/// Returns true if the cubic curve with the control points d, whose endpoints are within tolerance of zero, stays within it.
+static bool withinTolerance(const Vector2 d[4], double tolerance, int depth) {
+    // The curve lies within the convex hull of its control points
+    if (d[1].length() <= tolerance && d[2].length() <= tolerance)
+        return true;
+    Vector2 mid = .125*(d[0]+3*(d[1]+d[2])+d[3]);
+    if (mid.length() > tolerance)
+        return false;
+    if (!depth)
+        return true;
+    Vector2 midDirection = .125*(d[3]+d[2]-d[1]-d[0]);
+    Vector2 first[4] = { d[0], .5*(d[0]+d[1]), mid-midDirection, mid };
+    Vector2 second[4] = { mid, mid+midDirection, .5*(d[2]+d[3]), d[3] };
+    return withinTolerance(first, tolerance, depth-1) && withinTolerance(second, tolerance, depth-1);
+}
+
+/// Returns true if the quadratic curve q stays within tolerance of the cubic curve c, assuming their start points do.
+static bool quadraticWithinTolerance(const Point2 q[3], const Point2 c[4], double tolerance) {
+    // Degree elevation of the quadratic curve to a cubic curve
+    Vector2 d[4] = {
+        q[0]-c[0],
+        q[0]+2/3.*(q[1]-q[0])-c[1],
+        q[2]+2/3.*(q[1]-q[2])-c[2],
+        q[2]-c[3]
+    };
+    return d[3].length() <= tolerance && withinTolerance(d, tolerance, 16);
+}
+
+int CubicSegment::approximateByQuadratics(EdgeHolder parts[MSDFGEN_CUBIC_APPROXIMATION_MAX_PARTS], double tolerance) const {
+    if (p[1] == p[0] || p[2] == p[3])
+        return 0;
+    // A single part has its control point at the intersection of the endpoint tangents
+    Vector2 ab = p[1]-p[0], dc = p[2]-p[3];
+    double det = crossProduct(ab, dc);
+    if (det != 0) {
+        double s = crossProduct(p[3]-p[0], dc)/det, u = crossProduct(p[3]-p[0], ab)/det;
+        Point2 q[3] = { p[0], p[0]+s*ab, p[3] };
+        if (s > 0 && u > 0 && quadraticWithinTolerance(q, p, tolerance)) {
+            parts[0] = EdgeHolder(q[0], q[1], q[2], color);
+            return 1;
+        }
+    }
+    // Multiple parts form a quadratic spline whose joints lie halfway between consecutive control points,
+    // which are interpolated between the extensions of the cubic's tangents in each part of the curve
+    Point2 controls[MSDFGEN_CUBIC_APPROXIMATION_MAX_PARTS], joints[MSDFGEN_CUBIC_APPROXIMATION_MAX_PARTS+1];
+    for (int n = 2; n <= MSDFGEN_CUBIC_APPROXIMATION_MAX_PARTS; ++n) {
+        Point2 pieces[MSDFGEN_CUBIC_APPROXIMATION_MAX_PARTS][4];
+        for (int i = 0; i < n; ++i) {
+            double t0 = (double) i/n, t1 = (double) (i+1)/n;
+            Point2 *c = pieces[i];
+            c[0] = cubicPoint(p, t0);
+            c[1] = c[0]+(t1-t0)*cubicDirection(p, t0);
+            c[3] = cubicPoint(p, t1);
+            c[2] = c[3]-(t1-t0)*cubicDirection(p, t1);
+            controls[i] = mix(c[0]+1.5*(c[1]-c[0]), c[3]+1.5*(c[2]-c[3]), (double) i/(n-1));
+        }
+        joints[0] = p[0];
+        for (int i = 1; i < n; ++i)
+            joints[i] = .5*(controls[i-1]+controls[i]);
+        joints[n] = p[3];
+        bool fits = true;
+        for (int i = 0; i < n && fits; ++i) {
+            Point2 q[3] = { joints[i], controls[i], joints[i+1] };
+            fits = quadraticWithinTolerance(q, pieces[i], tolerance);
+        }
+        if (fits) {
+            for (int i = 0; i < n; ++i)
+                parts[i] = EdgeHolder(joints[i], controls[i], joints[i+1], color);
+            return n;
+        }
+    }
+    return 0;
 }
 
 }
@@ -7,9 +7,10 @@
 
 namespace msdfgen {
 
-// Parameters for iterative search of closest point on a cubic Bezier curve. Increase for higher precision.
-#define MSDFGEN_CUBIC_SEARCH_STARTS 4
-#define MSDFGEN_CUBIC_SEARCH_STEPS 4
+// Maximum number of quadratic segments approximating a single cubic segment.
+#define MSDFGEN_CUBIC_APPROXIMATION_MAX_PARTS 64
+
+class EdgeHolder;
 
 /// An abstract edge segment.
 class EdgeSegment {
@@ -37,7 +38,7 @@ public:
     /// Moves the end point of the edge segment.
     virtual void moveEndPoint(Point2 to) = 0;
     /// Splits the edge segments into thirds which together represent the original edge.
-    virtual void splitInThirds(EdgeSegment *&part1, EdgeSegment *&part2, EdgeSegment *&part3) const = 0;
+    virtual void splitInThirds(EdgeHolder &part1, EdgeHolder &part2, EdgeHolder &part3) const = 0;
 
 };
 
@@ -56,7 +57,7 @@ public:
 
     void moveStartPoint(Point2 to);
     void moveEndPoint(Point2 to);
-    void splitInThirds(EdgeSegment *&part1, EdgeSegment *&part2, EdgeSegment *&part3) const;
+    void splitInThirds(EdgeHolder &part1, EdgeHolder &part2, EdgeHolder &part3) const;
 
 };
 
@@ -75,7 +76,7 @@ public:
 
     void moveStartPoint(Point2 to);
     void moveEndPoint(Point2 to);
-    void splitInThirds(EdgeSegment *&part1, EdgeSegment *&part2, EdgeSegment *&part3) const;
+    void splitInThirds(EdgeHolder &part1, EdgeHolder &part2, EdgeHolder &part3) const;
 
 };
 
@@ -94,8 +95,60 @@ public:
 
     void moveStartPoint(Point2 to);
     void moveEndPoint(Point2 to);
-    void splitInThirds(EdgeSegment *&part1, EdgeSegment *&part2, EdgeSegment *&part3) const;
+    void splitInThirds(EdgeHolder &part1, EdgeHolder &part2, EdgeHolder &part3) const;
+    /** Approximates the segment by the minimal number of quadratic segments that deviate from it by at most tolerance.
+     *  The parts have the segment's color and its directions at the endpoints, and adjacent parts share their direction.
+     *  Returns the number of parts, or 0 if the segment has a degenerate endpoint direction or needs too many parts.
+     */
+    int approximateByQuadratics(EdgeHolder parts[MSDFGEN_CUBIC_APPROXIMATION_MAX_PARTS], double tolerance) const;
+
+};
+
+/// Terms of the signed distance to a linear segment that only depend on its control points.
+struct LinearSegmentTerms {
+    Vector2 ab, orthonormal;
+    /// Normalized direction of the segment.
+    Vector2 direction;
+    double abab;
+};
 
+/// Terms of the signed distance to a quadratic segment that only depend on its control points.
+struct QuadraticSegmentTerms {
+    Vector2 ab, br, bc, ac;
+    /// Normalized directions at the endpoints.
+    Vector2 startDirection, endDirection;
+    /// Leading coefficients of the cubic equation solved for the parameter of the nearest point.
+    double a, b;
+    double abab, bcbc;
 };
 
+/// Terms of the signed distance to a cubic segment that only depend on its control points.
+struct CubicSegmentTerms {
+    Vector2 ab, br, as;
+    /// Tangents at the endpoints and their squared lengths.
+    Vector2 startTangent, endTangent;
+    double startTangentSquared, endTangentSquared;
+    /// Normalized directions at the endpoints.
+    Vector2 startDirection, endDirection;
+    /// Coefficients of the quintic equation solved for the parameter of the nearest point, without the terms dependent on the origin.
+    double a, b, c, d, e;
+    /// Bounding box of the control points, which contains the segment.
+    Point2 boundsLo, boundsHi;
+};
+
+/// Computes the terms of the signed distance to a segment specified by its control points.
+void prepareLinearSegment(const Point2 p[2], LinearSegmentTerms &terms);
+void prepareQuadraticSegment(const Point2 p[3], QuadraticSegmentTerms &terms);
+void prepareCubicSegment(const Point2 p[4], CubicSegmentTerms &terms);
+
+/// Computes the signed distance between origin and a segment specified by its control points.
+SignedDistance linearSignedDistance(const Point2 p[2], Point2 origin, double &param);
+SignedDistance quadraticSignedDistance(const Point2 p[3], Point2 origin, double &param);
+SignedDistance cubicSignedDistance(const Point2 p[4], Point2 origin, double &param);
+
+/// Computes the signed distance between origin and a segment specified by its control points and their prepared terms.
+SignedDistance linearSignedDistance(const Point2 p[2], const LinearSegmentTerms &terms, Point2 origin, double &param);
+SignedDistance quadraticSignedDistance(const Point2 p[3], const QuadraticSegmentTerms &terms, Point2 origin, double &param);
+SignedDistance cubicSignedDistance(const Point2 p[4], const CubicSegmentTerms &terms, Point2 origin, double &param);
+
 }
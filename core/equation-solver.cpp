@@ -4,6 +4,11 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+// Maximum number of iterations of the safeguarded Newton's method used to refine a bracketed root.
+#define MSDFGEN_POLYNOMIAL_ROOT_ITERATIONS 64
+// Absolute precision of roots found by the safeguarded Newton's method.
+#define MSDFGEN_POLYNOMIAL_ROOT_PRECISION 1e-14
+
 namespace msdfgen {
 
 int solveQuadratic(double x[2], double a, double b, double c) {
@@ -66,4 +71,91 @@ int solveCubic(double x[3], double a, double b, double c, double d) {
     return solveCubicNormed(x, b/a, c/a, d/a);
 }
 
+/// Evaluates the polynomial with the coefficients c, ordered from the highest degree, at x.
+static double evaluatePolynomial(const double *c, int degree, double x) {
+    double y = c[0];
+    for (int i = 1; i <= degree; ++i)
+        y = y*x+c[i];
+    return y;
+}
+
+/// Finds the root of a polynomial monotonic in [lo, hi], whose value at lo has the sign of yLo and the opposite sign at hi.
+static double bracketedRoot(const double *c, const double *dc, int degree, double lo, double hi, double yLo) {
+    double x = .5*(lo+hi);
+    for (int i = 0; i < MSDFGEN_POLYNOMIAL_ROOT_ITERATIONS; ++i) {
+        double y = evaluatePolynomial(c, degree, x);
+        if (y == 0)
+            return x;
+        if ((y < 0) == (yLo < 0))
+            lo = x;
+        else
+            hi = x;
+        // Newton step, or bisection if it would leave the bracket
+        double next = x-y/evaluatePolynomial(dc, degree-1, x);
+        if (!(next > lo && next < hi))
+            next = .5*(lo+hi);
+        if (fabs(next-x) <= MSDFGEN_POLYNOMIAL_ROOT_PRECISION || hi-lo <= MSDFGEN_POLYNOMIAL_ROOT_PRECISION)
+            return next;
+        x = next;
+    }
+    return x;
+}
+
+/// Finds the roots of the polynomial with the coefficients c (at most quintic), ordered from the highest degree, in [lo, hi].
+static int solvePolynomial(double *x, const double *c, int degree, double lo, double hi) {
+    while (degree > 0 && c[0] == 0)
+        ++c, --degree;
+    if (degree == 0)
+        return 0;
+    if (degree == 1) {
+        x[0] = -c[1]/c[0];
+        return x[0] >= lo && x[0] <= hi;
+    }
+    if (degree == 2) {
+        double dscr = c[1]*c[1]-4*c[0]*c[2];
+        if (dscr < 0)
+            return 0;
+        // Avoids the cancellation of the textbook formula
+        double q = -.5*(c[1]+(c[1] < 0 ? -sqrt(dscr) : sqrt(dscr)));
+        double roots[2] = { q/c[0], q == 0 ? q/c[0] : c[2]/q };
+        if (roots[1] < roots[0]) {
+            double tmp = roots[0];
+            roots[0] = roots[1];
+            roots[1] = tmp;
+        }
+        int count = 0;
+        for (int i = 0; i < 2; ++i)
+            if (roots[i] >= lo && roots[i] <= hi && !(count && roots[i] == x[count-1]))
+                x[count++] = roots[i];
+        return count;
+    }
+    // The polynomial is monotonic between consecutive roots of its derivative, so each such interval contains at most one root
+    double dc[5] = { };
+    for (int i = 0; i < degree; ++i)
+        dc[i] = (degree-i)*c[i];
+    double bounds[6];
+    int boundCount = solvePolynomial(bounds+1, dc, degree-1, lo, hi)+2;
+    bounds[0] = lo;
+    bounds[boundCount-1] = hi;
+    int count = 0;
+    double a = lo, yA = evaluatePolynomial(c, degree, a);
+    for (int i = 1; i < boundCount; ++i) {
+        double b = bounds[i], yB = evaluatePolynomial(c, degree, b);
+        if (yA == 0) {
+            if (!(count && x[count-1] == a))
+                x[count++] = a;
+        } else if (yB != 0 && (yA < 0) != (yB < 0))
+            x[count++] = bracketedRoot(c, dc, degree, a, b, yA);
+        a = b, yA = yB;
+    }
+    if (yA == 0 && !(count && x[count-1] == a))
+        x[count++] = a;
+    return count;
+}
+
+int solveQuintic(double x[5], double a, double b, double c, double d, double e, double f, double lo, double hi) {
+    double coefficients[6] = { a, b, c, d, e, f };
+    return solvePolynomial(x, coefficients, 5, lo, hi);
+}
+
 }
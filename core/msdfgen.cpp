@@ -1,442 +1,1469 @@
 
 #include "../msdfgen.h"
 
+#include <algorithm>
 #include "arithmetics.hpp"
+#include "pixel-conversion.hpp"
+#include "ThreadPool.h"
 
 namespace msdfgen {
 
-struct MultiDistance {
-    double r, g, b;
-    double med;
+// Number of rows of a distance field generated by a single task.
+#define MSDFGEN_ROW_TILE_HEIGHT 4
+// Size of the blocks of pixels generated by a single task when saturated pixels are skipped.
+#define MSDFGEN_QUADTREE_BLOCK_SIZE 16
+// Size of the smallest cells tested for saturation, whose pixels are otherwise evaluated exactly.
+#define MSDFGEN_QUADTREE_LEAF_SIZE 4
+// Maximum number of parts an edge is divided into to bound its band of pixels in the edge-major generators.
+#define MSDFGEN_EDGE_BAND_MAX_PARTS 64
+
+struct EdgePoint {
+    SignedDistance minDistance;
+    double nearParam;
+    int nearEdge;
+};
+
+static inline void resetEdgePoint(EdgePoint &edgePoint) {
+    edgePoint.minDistance = SignedDistance();
+    edgePoint.nearParam = 0;
+    edgePoint.nearEdge = -1;
+}
+
+static inline void updateEdgePoint(EdgePoint &edgePoint, const SignedDistance &distance, double param, int edge) {
+    // Edges are visited out of order, so ties are resolved in favor of the lower index, exactly as in a linear scan
+    if (distance < edgePoint.minDistance || (edge < edgePoint.nearEdge && !(edgePoint.minDistance < distance))) {
+        edgePoint.minDistance = distance;
+        edgePoint.nearParam = param;
+        edgePoint.nearEdge = edge;
+    }
+}
+
+static inline void toPseudoDistance(EdgePoint &edgePoint, const FlatShape &shape, Point2 p) {
+    if (edgePoint.nearEdge >= 0)
+        shape.distanceToPseudoDistance(edgePoint.nearEdge, edgePoint.minDistance, p, edgePoint.nearParam);
+}
+
+static inline bool cullEdgePoint(const EdgeTree::Node &node, double x, double y, const EdgePoint &edgePoint) {
+    Point2 p(x, y);
+    double d = edgePoint.minDistance.distance;
+    // The relative tolerance makes sure that an edge is only culled if it cannot even tie with the current best
+    return node.distanceSquared(p, p) > d*d*(1+1e-9);
+}
+
+/// Edge tree visitor that finds the nearest edge regardless of color for a batch of points.
+class NearestEdgeQuery {
+
+public:
+    EdgePoint nearest[MSDFGEN_DISTANCE_BATCH];
+
+    NearestEdgeQuery(const FlatShape &shape, const double *x, const double *y) : shape(shape), x(x), y(y) {
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i)
+            resetEdgePoint(nearest[i]);
+    }
+    bool cull(const EdgeTree::Node &node) const {
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i)
+            if (!cullEdgePoint(node, x[i], y[i], nearest[i]))
+                return false;
+        return true;
+    }
+    void visit(int edge) {
+        SignedDistance distances[MSDFGEN_DISTANCE_BATCH];
+        double params[MSDFGEN_DISTANCE_BATCH];
+        shape.signedDistanceBatch(edge, x, y, distances, params);
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i)
+            updateEdgePoint(nearest[i], distances[i], params[i], edge);
+    }
+
+private:
+    const FlatShape &shape;
+    const double *x, *y;
+
+};
+
+/// Edge tree visitor that finds the nearest edge separately for each color channel for a batch of points.
+/// If trueDistance is set, it also finds the nearest edge regardless of color in the same traversal.
+template <bool trueDistance>
+class NearestEdgeColorQuery {
+
+public:
+    EdgePoint r[MSDFGEN_DISTANCE_BATCH], g[MSDFGEN_DISTANCE_BATCH], b[MSDFGEN_DISTANCE_BATCH];
+    /// The nearest edge of any color, only valid if trueDistance is set.
+    EdgePoint nearest[MSDFGEN_DISTANCE_BATCH];
+
+    NearestEdgeColorQuery(const FlatShape &shape, const double *x, const double *y) : shape(shape), x(x), y(y) {
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i) {
+            resetEdgePoint(r[i]);
+            resetEdgePoint(g[i]);
+            resetEdgePoint(b[i]);
+            if (trueDistance)
+                resetEdgePoint(nearest[i]);
+        }
+    }
+    bool cull(const EdgeTree::Node &node) const {
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i) {
+            if ((node.colors&RED && !cullEdgePoint(node, x[i], y[i], r[i]))
+                || (node.colors&GREEN && !cullEdgePoint(node, x[i], y[i], g[i]))
+                || (node.colors&BLUE && !cullEdgePoint(node, x[i], y[i], b[i]))
+                || (trueDistance && !cullEdgePoint(node, x[i], y[i], nearest[i])))
+                return false;
+        }
+        return true;
+    }
+    void visit(int edge) {
+        SignedDistance distances[MSDFGEN_DISTANCE_BATCH];
+        double params[MSDFGEN_DISTANCE_BATCH];
+        shape.signedDistanceBatch(edge, x, y, distances, params);
+        int color = shape.edgeColors[edge];
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i) {
+            if (color&RED)
+                updateEdgePoint(r[i], distances[i], params[i], edge);
+            if (color&GREEN)
+                updateEdgePoint(g[i], distances[i], params[i], edge);
+            if (color&BLUE)
+                updateEdgePoint(b[i], distances[i], params[i], edge);
+            if (trueDistance)
+                updateEdgePoint(nearest[i], distances[i], params[i], edge);
+        }
+    }
+
+private:
+    const FlatShape &shape;
+    const double *x, *y;
+
+};
+
+/// A batch of horizontally adjacent pixels, whose positions are evaluated together.
+struct PixelBatch {
+    /// Number of valid pixels, the remaining lanes repeat the last one.
+    int count;
+    double x[MSDFGEN_DISTANCE_BATCH], y[MSDFGEN_DISTANCE_BATCH];
+    /// Bounding box of the pixel positions.
+    Point2 lo, hi;
+
+    PixelBatch(int x0, int y0, int x1, const Vector2 &scale, const Vector2 &translate) {
+        count = min(MSDFGEN_DISTANCE_BATCH, x1-x0);
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i) {
+            Point2 p = Vector2(x0+min(i, count-1)+.5, y0+.5)/scale-translate;
+            x[i] = p.x, y[i] = p.y;
+        }
+        lo = hi = Point2(x[0], y[0]);
+        for (int i = 1; i < MSDFGEN_DISTANCE_BATCH; ++i) {
+            lo.x = min(lo.x, x[i]), lo.y = min(lo.y, y[i]);
+            hi.x = max(hi.x, x[i]), hi.y = max(hi.y, y[i]);
+        }
+    }
+    Point2 point(int i) const {
+        return Point2(x[i], y[i]);
+    }
+};
+
+/// The shape and parameters shared by all rows of a generated distance field.
+struct GeneratorContext {
+    const FlatShape &shape;
+    const std::vector<EdgeTree> &trees;
+    double range;
+    Vector2 scale, translate;
+    FillRule fillRule;
+    /// The intersections of the shape with each row of pixels, which determine their signs. Unused by the legacy generators.
+    std::vector<Scanline> scanlines;
+
+    GeneratorContext(const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO) : shape(shape.shape), trees(shape.trees), range(range), scale(scale), translate(translate), fillRule(fillRule) { }
+};
+
+/// Computes the pixels of a distance field from x0 to x1 (exclusive) in rows y0 to y1 (exclusive).
+template <typename T>
+struct PixelFunction {
+    typedef void (*Type)(const BitmapRef<T> &output, const GeneratorContext &context, int x0, int y0, int x1, int y1);
+};
+
+/// Generates the rows of a distance field in tiles of MSDFGEN_ROW_TILE_HEIGHT rows, which are distributed among the threads.
+template <typename T>
+class RowTileJob : public ThreadPool::Job {
+
+public:
+    RowTileJob(typename PixelFunction<T>::Type pixelFunction, const BitmapRef<T> &output, const GeneratorContext &context) : pixelFunction(pixelFunction), output(output), context(context) { }
+    void execute(int task) {
+        int begin = task*MSDFGEN_ROW_TILE_HEIGHT;
+        (*pixelFunction)(output, context, 0, begin, output.width(), min(begin+MSDFGEN_ROW_TILE_HEIGHT, output.height()));
+    }
+
+private:
+    typename PixelFunction<T>::Type pixelFunction;
+    BitmapRef<T> output;
+    const GeneratorContext &context;
+
 };
 
-static inline bool pixelClash(const FloatRGB &a, const FloatRGB &b, double threshold) {
+/// Computes the scanlines of the rows of a distance field in tiles of MSDFGEN_ROW_TILE_HEIGHT rows.
+class ScanlineJob : public ThreadPool::Job {
+
+public:
+    explicit ScanlineJob(GeneratorContext &context) : context(context) { }
+    void execute(int task) {
+        int begin = task*MSDFGEN_ROW_TILE_HEIGHT, end = min(begin+MSDFGEN_ROW_TILE_HEIGHT, (int) context.scanlines.size());
+        for (int y = begin; y < end; ++y)
+            context.shape.scanline(context.scanlines[y], (y+.5)/context.scale.y-context.translate.y);
+    }
+
+private:
+    GeneratorContext &context;
+
+};
+
+static void computeScanlines(GeneratorContext &context, int height) {
+    context.scanlines.resize(height);
+    ScanlineJob job(context);
+    ThreadPool::shared().run(job, (height+MSDFGEN_ROW_TILE_HEIGHT-1)/MSDFGEN_ROW_TILE_HEIGHT);
+}
+
+/// Bounds of the distances of a channel over a cell of pixels.
+struct DistanceBounds {
+    /// The sign of the distances, or zero if it is unknown.
+    int sign;
+    /// Lower bound of the absolute value of the pseudo-distances.
+    double lo;
+};
+
+/// Properties of an edge that determine where the sign of its distance may change.
+struct EdgeSides {
+    /// Whether the edge together with rays extending it along its tangents at the endpoints is a simple curve,
+    /// which requires it not to turn by more than half a revolution and not to change the direction of turning.
+    bool separating;
+    /// Channels shared with the adjacent edge at the start and end point. Beyond a shared endpoint, the adjacent edge
+    /// is nearer or wins the tie, so the edge's extension ray does not affect the sign of the channel.
+    int startShared, endShared;
+};
+
+static bool separatesPlane(const FlatShape &shape, int edge) {
+    const Point2 *p;
+    int count = shape.controlPoints(edge, p)+1;
+    if (count == 2)
+        return true;
+    // A convex control polygon guarantees a curve without inflections
+    bool left = false, right = false;
+    for (int i = 0; i < count; ++i) {
+        double turn = crossProduct(p[(i+1)%count]-p[i], p[(i+2)%count]-p[(i+1)%count]);
+        left |= turn > 0, right |= turn < 0;
+    }
+    if (left && right)
+        return false;
+    double turn = crossProduct(shape.startDirections[edge], shape.endDirections[edge]);
+    if (turn == 0)
+        return dotProduct(shape.startDirections[edge], shape.endDirections[edge]) > 0;
+    return left ? turn > 0 : turn < 0;
+}
+
+/** Edge tree visitor that collects the candidate edges of a shape, which may be the nearest edge of their channel for
+ *  some point of a cell, given by an upper bound of their distance from the cell's center, and bounds their pseudo-distances
+ *  over the cell. The distance to an edge changes by at most the distance travelled, its pseudo-distance is at least the
+ *  distance to its extension rays, and its sign is constant on either side of the edge extended by these rays.
+ *  The signs are only tracked for multi-channel distance fields, where they are not determined by the scanlines.
+ */
+class CandidateEdgeQuery {
+
+public:
+    /// Bounds of the distances of each channel's candidates. Only the first is used for single-channel distance fields.
+    DistanceBounds channels[3];
+
+    CandidateEdgeQuery(const FlatShape &shape, const std::vector<EdgeSides> &sides, const Point2 &lo, const Point2 &hi, bool multi) : shape(shape), sides(sides), lo(lo), hi(hi), center(.5*(lo+hi)), radius(.5*(hi-lo).length()), multi(multi) { }
+    /// Sets the distance from the center of the nearest edge of each channel, which must be set before the query.
+    void reset(double r, double g, double b) {
+        double nearest[3] = { r, g, b };
+        for (int i = 0; i < 3; ++i) {
+            // Within a channel, the nearest edge of any point of the cell is at most one diameter farther from the center than the nearest edge of the center
+            bounds[i] = nearest[i]+2*radius;
+            channels[i].sign = 0;
+            channels[i].lo = nearest[i]-radius;
+        }
+    }
+    bool cull(const EdgeTree::Node &node) const {
+        int colors = multi ? node.colors : WHITE;
+        double bound = 0;
+        for (int i = 0; i < 3; ++i)
+            if (colors&1<<i && channels[i].sign != INCONSISTENT)
+                bound = max(bound, bounds[i]);
+        return node.distanceSquared(center, center) > bound*bound*(1+1e-9);
+    }
+    void visit(int edge) {
+        int color = multi ? shape.edgeColors[edge] : WHITE;
+        double param;
+        SignedDistance distance = shape.signedDistance(edge, center, param);
+        double d = fabs(distance.distance);
+        int sign = distance.distance > 0 ? 1 : -1;
+        const EdgeSides &edgeSides = sides[edge];
+        double startDistance = -1, endDistance = -1;
+        for (int i = 0; i < 3; ++i) {
+            if (!(color&1<<i && d <= bounds[i]*(1+1e-9)))
+                continue;
+            DistanceBounds &channel = channels[i];
+            if (channel.sign == INCONSISTENT)
+                continue;
+            if (startDistance < 0) {
+                startDistance = rayDistance(shape.startPoints[edge], -shape.startDirections[edge]);
+                endDistance = rayDistance(shape.endPoints[edge], shape.endDirections[edge]);
+            }
+            // Pseudo-distances beyond either endpoint are distances from the extension rays
+            channel.lo = min(channel.lo, min(startDistance, endDistance));
+            if (multi) {
+                // The sign only changes across the rays at endpoints not shared with an adjacent edge of the same channel
+                bool consistent = edgeSides.separating && d > radius
+                    && (edgeSides.startShared&1<<i || startDistance > 0)
+                    && (edgeSides.endShared&1<<i || endDistance > 0);
+                channel.sign = consistent && (!channel.sign || channel.sign == sign) ? sign : INCONSISTENT;
+            }
+        }
+    }
+
+private:
+    static const int INCONSISTENT = 2;
+
+    const FlatShape &shape;
+    const std::vector<EdgeSides> &sides;
+    Point2 lo, hi, center;
+    double radius;
+    bool multi;
+    double bounds[3];
+
+    /// Returns the distance between the cell and the ray from origin in direction.
+    double rayDistance(const Point2 &origin, const Vector2 &direction) const {
+        // Range of the ray's parameter inside the cell
+        double tMin = 0, tMax = fabs(SignedDistance::INFINITE.distance);
+        for (int axis = 0; axis < 2; ++axis) {
+            double o = axis ? origin.y : origin.x, v = axis ? direction.y : direction.x;
+            double l = axis ? lo.y : lo.x, h = axis ? hi.y : hi.x;
+            if (v == 0) {
+                if (o < l || o > h)
+                    tMax = -1;
+            } else {
+                double t0 = (l-o)/v, t1 = (h-o)/v;
+                tMin = max(tMin, min(t0, t1));
+                tMax = min(tMax, max(t0, t1));
+            }
+        }
+        if (tMin <= tMax)
+            return 0;
+        // Otherwise, the nearest points are the origin and a corner of the cell
+        double dx = max(max(lo.x-origin.x, origin.x-hi.x), 0.), dy = max(max(lo.y-origin.y, origin.y-hi.y), 0.);
+        double result = sqrt(dx*dx+dy*dy);
+        Point2 corners[4] = { lo, Point2(hi.x, lo.y), Point2(lo.x, hi.y), hi };
+        for (int i = 0; i < 4; ++i) {
+            Vector2 q = corners[i]-origin;
+            result = min(result, (q-max(dotProduct(q, direction), 0.)*direction).length());
+        }
+        return result;
+    }
+
+};
+
+/// The true distance of the nearest edge from a point, which bounds the distances over cells nearby.
+struct NearestDistanceHint {
+    Point2 origin;
+    double distance;
+
+    NearestDistanceHint() : distance(fabs(SignedDistance::INFINITE.distance)) { }
+};
+
+/** Determines whether cells of pixels are saturated, i.e. whether each channel of the distance field is provably at
+ *  least half the range away from zero with the same sign in all of their pixels. The signs follow from the scanlines,
+ *  and for multi-channel distance fields also from the signs of the candidate edges of each channel.
+ */
+class SaturationTest {
+
+public:
+    SaturationTest(const GeneratorContext &context, bool pseudo, bool multi) : context(context), pseudo(pseudo), multi(multi), sides(context.shape.edgeCount()) {
+        const FlatShape &flat = context.shape;
+        for (int i = 0, contourCount = flat.contourCount(); i < contourCount; ++i) {
+            int first = flat.contourStarts[i], last = flat.contourStarts[i+1]-1;
+            for (int edge = first; edge <= last; ++edge) {
+                int next = edge < last ? edge+1 : first;
+                sides[edge].separating = separatesPlane(flat, edge);
+                sides[edge].endShared = sides[next].startShared = 0;
+                if (next != edge && flat.endPoints[edge] == flat.startPoints[next])
+                    sides[edge].endShared = sides[next].startShared = multi ? flat.edgeColors[edge]&flat.edgeColors[next] : WHITE;
+            }
+        }
+    }
+    /** Returns true if all pixels from x0 to x1 (exclusive) in rows y0 to y1 (exclusive) are saturated and sets the sign
+     *  of each channel (only the first one for single-channel distance fields). The hint, if any, is updated if the cell
+     *  is found to be too close to an edge, in which case the hint may save testing cells inside it.
+     */
+    bool saturated(int x0, int y0, int x1, int y1, int signs[3], NearestDistanceHint &hint) const {
+        const FlatShape &flat = context.shape;
+        Point2 a = Vector2(x0+.5, y0+.5)/context.scale-context.translate;
+        Point2 b = Vector2(x1-.5, y1-.5)/context.scale-context.translate;
+        Point2 lo(min(a.x, b.x), min(a.y, b.y)), hi(max(a.x, b.x), max(a.y, b.y));
+        Point2 center = .5*(lo+hi);
+        double radius = .5*(hi-lo).length();
+        double x[MSDFGEN_DISTANCE_BATCH], y[MSDFGEN_DISTANCE_BATCH];
+        for (int i = 0; i < MSDFGEN_DISTANCE_BATCH; ++i)
+            x[i] = center.x, y[i] = center.y;
+        // Pixels saturate to 1 at a distance of half the range and to 0 at minus half the range
+        double limit = .5*context.range*(1+1e-9);
+        if (hint.distance+(center-hint.origin).length()-radius < limit)
+            return false;
+        int contourCount = flat.contourCount();
+        // The distances of the nearest edges are checked first, as most cells fail this test
+        double nearest[3];
+        if (multi) {
+            NearestEdgeColorQuery<false> query(flat, x, y);
+            for (int i = 0; i < contourCount; ++i)
+                context.trees[i].query(center, center, query);
+            if (query.r[0].nearEdge < 0 || query.g[0].nearEdge < 0 || query.b[0].nearEdge < 0)
+                return false;
+            nearest[0] = fabs(query.r[0].minDistance.distance);
+            nearest[1] = fabs(query.g[0].minDistance.distance);
+            nearest[2] = fabs(query.b[0].minDistance.distance);
+        } else {
+            NearestEdgeQuery query(flat, x, y);
+            for (int i = 0; i < contourCount; ++i)
+                context.trees[i].query(center, center, query);
+            if (query.nearest[0].nearEdge < 0)
+                return false;
+            nearest[0] = nearest[1] = nearest[2] = fabs(query.nearest[0].minDistance.distance);
+        }
+        double minDistance = min(min(nearest[0], nearest[1]), nearest[2]);
+        if (minDistance-radius < limit) {
+            hint.origin = center;
+            hint.distance = minDistance;
+            return false;
+        }
+        // No edge passes through the cell, so it is either filled or empty as a whole
+        int fillSign = context.scanlines[y0].filled(a.x, context.fillRule) ? 1 : -1;
+        signs[0] = signs[1] = signs[2] = fillSign;
+        if (!pseudo)
+            return true;
+
+        CandidateEdgeQuery query(flat, sides, lo, hi, multi);
+        query.reset(nearest[0], nearest[1], nearest[2]);
+        for (int i = 0; i < contourCount; ++i)
+            context.trees[i].query(center, center, query);
+        int channelCount = multi ? 3 : 1;
+        for (int i = 0; i < channelCount; ++i)
+            if (query.channels[i].lo < limit || (multi && abs(query.channels[i].sign) != 1))
+                return false;
+        if (multi) {
+            // All channels are negated if their median contradicts the scanline
+            int medianSign = median(query.channels[0].sign, query.channels[1].sign, query.channels[2].sign);
+            for (int i = 0; i < 3; ++i)
+                signs[i] = medianSign == fillSign ? query.channels[i].sign : -query.channels[i].sign;
+        }
+        return true;
+    }
+
+private:
+    const GeneratorContext &context;
+    bool pseudo, multi;
+    std::vector<EdgeSides> sides;
+
+};
+
+/// Stores a channel value, where 0.5 is the edge, in a channel of an output pixel. 8-bit outputs are quantized like the image writers do.
+static inline void storeChannel(float &channel, double value) {
+    channel = float(value);
+}
+
+static inline void storeChannel(unsigned char &channel, double value) {
+    channel = pixelFloatToByte(float(value));
+}
+
+static inline void storeChannel(Half &channel, double value) {
+    channel = floatToHalf(float(value));
+}
+
+template <typename T>
+static inline void storeColorChannels(T &pixel, const double *distances, double range) {
+    storeChannel(pixel.r, distances[0]/range+.5);
+    storeChannel(pixel.g, distances[1]/range+.5);
+    storeChannel(pixel.b, distances[2]/range+.5);
+}
+
+/// Stores the channel distances of a pixel, given in shape units, in an output pixel of any of the supported types.
+static inline void storePixel(float &pixel, const double *distances, double range) {
+    storeChannel(pixel, distances[0]/range+.5);
+}
+
+static inline void storePixel(unsigned char &pixel, const double *distances, double range) {
+    storeChannel(pixel, distances[0]/range+.5);
+}
+
+static inline void storePixel(Half &pixel, const double *distances, double range) {
+    storeChannel(pixel, distances[0]/range+.5);
+}
+
+static inline void storePixel(FloatRGB &pixel, const double *distances, double range) {
+    storeColorChannels(pixel, distances, range);
+}
+
+static inline void storePixel(ByteRGB &pixel, const double *distances, double range) {
+    storeColorChannels(pixel, distances, range);
+}
+
+static inline void storePixel(HalfRGB &pixel, const double *distances, double range) {
+    storeColorChannels(pixel, distances, range);
+}
+
+static inline void storePixel(FloatRGBA &pixel, const double *distances, double range) {
+    storeColorChannels(pixel, distances, range);
+    storeChannel(pixel.a, distances[3]/range+.5);
+}
+
+static inline void storePixel(ByteRGBA &pixel, const double *distances, double range) {
+    storeColorChannels(pixel, distances, range);
+    storeChannel(pixel.a, distances[3]/range+.5);
+}
+
+static inline void storePixel(HalfRGBA &pixel, const double *distances, double range) {
+    storeColorChannels(pixel, distances, range);
+    storeChannel(pixel.a, distances[3]/range+.5);
+}
+
+/// Stores a floating-point multi-channel pixel in an output pixel with the same channels.
+template <typename O>
+static inline void convertPixel(O &output, const FloatRGB &pixel) {
+    storeChannel(output.r, pixel.r);
+    storeChannel(output.g, pixel.g);
+    storeChannel(output.b, pixel.b);
+}
+
+template <typename O>
+static inline void convertPixel(O &output, const FloatRGBA &pixel) {
+    storeChannel(output.r, pixel.r);
+    storeChannel(output.g, pixel.g);
+    storeChannel(output.b, pixel.b);
+    storeChannel(output.a, pixel.a);
+}
+
+/// Sets a saturated pixel to 0 or 1 in each channel according to the signs of the channels.
+template <typename T>
+static inline void fillPixel(T &pixel, const int signs[3]) {
+    // The median of the signs always agrees with the scanline, which gives the sign of the true distance
+    double distances[4] = { signs[0] > 0 ? .5 : -.5, signs[1] > 0 ? .5 : -.5, signs[2] > 0 ? .5 : -.5, median(signs[0], signs[1], signs[2]) > 0 ? .5 : -.5 };
+    storePixel(pixel, distances, 1);
+}
+
+/** Generates a distance field in square blocks of MSDFGEN_QUADTREE_BLOCK_SIZE pixels, which are distributed among the
+ *  threads. Saturated blocks are filled without evaluating their pixels, the others are recursively divided into
+ *  quadrants down to MSDFGEN_QUADTREE_LEAF_SIZE pixels, which are evaluated exactly. Filled pixels are marked in a mask.
+ */
+template <typename T>
+class QuadtreeJob : public ThreadPool::Job {
+
+public:
+    QuadtreeJob(typename PixelFunction<T>::Type pixelFunction, bool pseudo, bool multi, const BitmapRef<T> &output, const GeneratorContext &context, std::vector<char> &filled) : pixelFunction(pixelFunction), saturation(context, pseudo, multi), output(output), context(context), filled(filled) { }
+    void execute(int task) {
+        int columns = (output.width()+MSDFGEN_QUADTREE_BLOCK_SIZE-1)/MSDFGEN_QUADTREE_BLOCK_SIZE;
+        int x0 = task%columns*MSDFGEN_QUADTREE_BLOCK_SIZE, y0 = task/columns*MSDFGEN_QUADTREE_BLOCK_SIZE;
+        generateCell(x0, y0, min(x0+MSDFGEN_QUADTREE_BLOCK_SIZE, output.width()), min(y0+MSDFGEN_QUADTREE_BLOCK_SIZE, output.height()), NearestDistanceHint());
+    }
+
+private:
+    typename PixelFunction<T>::Type pixelFunction;
+    SaturationTest saturation;
+    BitmapRef<T> output;
+    const GeneratorContext &context;
+    std::vector<char> &filled;
+
+    void generateCell(int x0, int y0, int x1, int y1, NearestDistanceHint hint) {
+        int signs[3];
+        if (saturation.saturated(x0, y0, x1, y1, signs, hint)) {
+            int w = output.width(), h = output.height();
+            for (int y = y0; y < y1; ++y) {
+                int row = context.shape.inverseYAxis ? h-y-1 : y;
+                for (int x = x0; x < x1; ++x) {
+                    fillPixel(output(x, row), signs);
+                    filled[w*row+x] = 1;
+                }
+            }
+        } else if (x1-x0 <= MSDFGEN_QUADTREE_LEAF_SIZE && y1-y0 <= MSDFGEN_QUADTREE_LEAF_SIZE)
+            (*pixelFunction)(output, context, x0, y0, x1, y1);
+        else {
+            int xm = x1-x0 > MSDFGEN_QUADTREE_LEAF_SIZE ? (x0+x1)/2 : x1;
+            int ym = y1-y0 > MSDFGEN_QUADTREE_LEAF_SIZE ? (y0+y1)/2 : y1;
+            generateCell(x0, y0, xm, ym, hint);
+            if (xm < x1)
+                generateCell(xm, y0, x1, ym, hint);
+            if (ym < y1) {
+                generateCell(x0, ym, xm, y1, hint);
+                if (xm < x1)
+                    generateCell(xm, ym, x1, y1, hint);
+            }
+        }
+    }
+
+};
+
+template <typename T>
+static void generateRowTiles(typename PixelFunction<T>::Type pixelFunction, const BitmapRef<T> &output, const GeneratorContext &context) {
+    RowTileJob<T> job(pixelFunction, output, context);
+    // Every pixel is computed independently, so the output does not depend on the number of threads
+    ThreadPool::shared().run(job, (output.height()+MSDFGEN_ROW_TILE_HEIGHT-1)/MSDFGEN_ROW_TILE_HEIGHT);
+}
+
+template <typename T>
+static void generateQuadtree(typename PixelFunction<T>::Type pixelFunction, bool pseudo, bool multi, const BitmapRef<T> &output, const GeneratorContext &context, std::vector<char> &filled) {
+    filled.assign(output.width()*output.height(), 0);
+    QuadtreeJob<T> job(pixelFunction, pseudo, multi, output, context, filled);
+    int columns = (output.width()+MSDFGEN_QUADTREE_BLOCK_SIZE-1)/MSDFGEN_QUADTREE_BLOCK_SIZE;
+    int rows = (output.height()+MSDFGEN_QUADTREE_BLOCK_SIZE-1)/MSDFGEN_QUADTREE_BLOCK_SIZE;
+    ThreadPool::shared().run(job, columns*rows);
+}
+
+/// Per-pixel channel classification used by the clash test: bit i of above (below) is set if channel i is above (below) .5.
+struct ChannelSides {
+    int above, below;
+
+    template <typename T>
+    explicit ChannelSides(const T &pixel) {
+        above = (pixel.r > .5f)|(pixel.g > .5f)<<1|(pixel.b > .5f)<<2;
+        below = (pixel.r < .5f)|(pixel.g < .5f)<<1|(pixel.b < .5f)<<2;
+    }
+};
+
+template <typename T>
+static inline bool pixelClash(const T &a, const ChannelSides &as, const T &b, const ChannelSides &bs, double threshold) {
+    // Whether at least two channels are above .5, for each combination of channel bits
+    static const bool inside[8] = { false, false, false, true, false, true, true, true };
+    // For each combination of changing channels, the remaining channel, or -1 if the pair does not qualify.
+    // If all three channels change, red and green are considered the changing pair.
+    static const int remaining[8] = { -1, -1, -1, 2, -1, 1, 0, 2 };
     // Only consider pair where both are on the inside or both are on the outside
-    bool aIn = (a.r > .5f)+(a.g > .5f)+(a.b > .5f) >= 2;
-    bool bIn = (b.r > .5f)+(b.g > .5f)+(b.b > .5f) >= 2;
-    if (aIn != bIn) return false;
     // If the change is 0 <-> 1 or 2 <-> 3 channels and not 1 <-> 1 or 2 <-> 2, it is not a clash
-    if ((a.r > .5f && a.g > .5f && a.b > .5f) || (a.r < .5f && a.g < .5f && a.b < .5f)
-        || (b.r > .5f && b.g > .5f && b.b > .5f) || (b.r < .5f && b.g < .5f && b.b < .5f))
+    if (inside[as.above] != inside[bs.above] || as.above == 7 || as.below == 7 || bs.above == 7 || bs.below == 7)
         return false;
-    // Find which color is which: _a, _b = the changing channels, _c = the remaining one
-    float aa, ab, ba, bb, ac, bc;
-    if ((a.r > .5f) != (b.r > .5f) && (a.r < .5f) != (b.r < .5f)) {
-        aa = a.r, ba = b.r;
-        if ((a.g > .5f) != (b.g > .5f) && (a.g < .5f) != (b.g < .5f)) {
-            ab = a.g, bb = b.g;
-            ac = a.b, bc = b.b;
-        } else if ((a.b > .5f) != (b.b > .5f) && (a.b < .5f) != (b.b < .5f)) {
-            ab = a.b, bb = b.b;
-            ac = a.g, bc = b.g;
-        } else
-            return false; // this should never happen
-    } else if ((a.g > .5f) != (b.g > .5f) && (a.g < .5f) != (b.g < .5f)
-        && (a.b > .5f) != (b.b > .5f) && (a.b < .5f) != (b.b < .5f)) {
-        aa = a.g, ba = b.g;
-        ab = a.b, bb = b.b;
-        ac = a.r, bc = b.r;
-    } else
+    int c = remaining[(as.above^bs.above)&(as.below^bs.below)];
+    if (c < 0)
         return false;
+    float ac[3] = { a.r, a.g, a.b }, bc[3] = { b.r, b.g, b.b };
+    int i = c == 0 ? 1 : 0, j = c == 2 ? 1 : 2;
     // Find if the channels are in fact discontinuous
-    return (fabsf(aa-ba) >= threshold)
-        && (fabsf(ab-bb) >= threshold)
-        && fabsf(ac-.5f) >= fabsf(bc-.5f); // Out of the pair, only flag the pixel farther from a shape edge
-}
-
-void msdfErrorCorrection(Bitmap<FloatRGB> &output, const Vector2 &threshold) {
-    std::vector<std::pair<int, int> > clashes;
-    int w = output.width(), h = output.height();
-    for (int y = 0; y < h; ++y)
-        for (int x = 0; x < w; ++x) {
-            if ((x > 0 && pixelClash(output(x, y), output(x-1, y), threshold.x))
-                || (x < w-1 && pixelClash(output(x, y), output(x+1, y), threshold.x))
-                || (y > 0 && pixelClash(output(x, y), output(x, y-1), threshold.y))
-                || (y < h-1 && pixelClash(output(x, y), output(x, y+1), threshold.y)))
-                clashes.push_back(std::make_pair(x, y));
-        }
-    for (std::vector<std::pair<int, int> >::const_iterator clash = clashes.begin(); clash != clashes.end(); ++clash) {
-        FloatRGB &pixel = output(clash->first, clash->second);
-        float med = median(pixel.r, pixel.g, pixel.b);
-        pixel.r = med, pixel.g = med, pixel.b = med;
-    }
-}
-
-void generateSDF(Bitmap<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
-    int contourCount = shape.contours.size();
-    int w = output.width(), h = output.height();
-    std::vector<int> windings;
-    windings.reserve(contourCount);
-    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
-        windings.push_back(contour->winding());
-
-#ifdef MSDFGEN_USE_OPENMP
-    #pragma omp parallel
-#endif
-    {
-        std::vector<double> contourSD;
-        contourSD.resize(contourCount);
-#ifdef MSDFGEN_USE_OPENMP
-        #pragma omp for
-#endif
-        for (int y = 0; y < h; ++y) {
-            int row = shape.inverseYAxis ? h-y-1 : y;
+    return (fabsf(ac[i]-bc[i]) >= threshold)
+        && (fabsf(ac[j]-bc[j]) >= threshold)
+        && fabsf(ac[c]-.5f) >= fabsf(bc[c]-.5f); // Out of the pair, only flag the pixel farther from a shape edge
+}
+
+/// Marks the clashing pixels of a tile of rows in the clash mask.
+template <typename T>
+class ClashDetectionJob : public ThreadPool::Job {
+
+public:
+    ClashDetectionJob(const BitmapRef<T> &output, const Vector2 &threshold, std::vector<char> &clashes) : output(output), threshold(threshold), clashes(clashes) { }
+    void execute(int task) {
+        int w = output.width(), h = output.height();
+        for (int y = task*MSDFGEN_ROW_TILE_HEIGHT, end = min(y+MSDFGEN_ROW_TILE_HEIGHT, h); y < end; ++y)
             for (int x = 0; x < w; ++x) {
-                double dummy;
-                Point2 p = Vector2(x+.5, y+.5)/scale-translate;
-                double negDist = -SignedDistance::INFINITE.distance;
-                double posDist = SignedDistance::INFINITE.distance;
-                int winding = 0;
-
-                std::vector<Contour>::const_iterator contour = shape.contours.begin();
-                for (int i = 0; i < contourCount; ++i, ++contour) {
-                    SignedDistance minDistance;
-                    for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
-                        SignedDistance distance = (*edge)->signedDistance(p, dummy);
-                        if (distance < minDistance)
-                            minDistance = distance;
-                    }
-                    contourSD[i] = minDistance.distance;
-                    if (windings[i] > 0 && minDistance.distance >= 0 && fabs(minDistance.distance) < fabs(posDist))
-                        posDist = minDistance.distance;
-                    if (windings[i] < 0 && minDistance.distance <= 0 && fabs(minDistance.distance) < fabs(negDist))
-                        negDist = minDistance.distance;
-                }
+                const T &pixel = output(x, y);
+                ChannelSides sides(pixel);
+                clashes[w*y+x] = (x > 0 && pixelClash(pixel, sides, output(x-1, y), ChannelSides(output(x-1, y)), threshold.x))
+                    || (x < w-1 && pixelClash(pixel, sides, output(x+1, y), ChannelSides(output(x+1, y)), threshold.x))
+                    || (y > 0 && pixelClash(pixel, sides, output(x, y-1), ChannelSides(output(x, y-1)), threshold.y))
+                    || (y < h-1 && pixelClash(pixel, sides, output(x, y+1), ChannelSides(output(x, y+1)), threshold.y));
+            }
+    }
 
-                double sd = SignedDistance::INFINITE.distance;
-                if (posDist >= 0 && fabs(posDist) <= fabs(negDist)) {
-                    sd = posDist;
-                    winding = 1;
-                    for (int i = 0; i < contourCount; ++i)
-                        if (windings[i] > 0 && contourSD[i] > sd && fabs(contourSD[i]) < fabs(negDist))
-                            sd = contourSD[i];
-                } else if (negDist <= 0 && fabs(negDist) <= fabs(posDist)) {
-                    sd = negDist;
-                    winding = -1;
-                    for (int i = 0; i < contourCount; ++i)
-                        if (windings[i] < 0 && contourSD[i] < sd && fabs(contourSD[i]) < fabs(posDist))
-                            sd = contourSD[i];
-                }
-                for (int i = 0; i < contourCount; ++i)
-                    if (windings[i] != winding && fabs(contourSD[i]) < fabs(sd))
-                        sd = contourSD[i];
+private:
+    BitmapRef<T> output;
+    Vector2 threshold;
+    std::vector<char> &clashes;
+
+};
+
+/** Replaces the color channels of the pixels of a tile of rows marked in the clash mask by their median.
+ *  Unless the output is the distance field itself, all of its pixels are converted from the distance field along the way.
+ */
+template <typename T, typename O>
+class ClashCorrectionJob : public ThreadPool::Job {
+
+public:
+    ClashCorrectionJob(const BitmapRef<T> &distances, const BitmapRef<O> &output, const std::vector<char> &clashes, bool inPlace) : distances(distances), output(output), clashes(clashes), inPlace(inPlace) { }
+    void execute(int task) {
+        int w = distances.width(), h = distances.height();
+        for (int y = task*MSDFGEN_ROW_TILE_HEIGHT, end = min(y+MSDFGEN_ROW_TILE_HEIGHT, h); y < end; ++y)
+            for (int x = 0; x < w; ++x)
+                if (clashes[w*y+x]) {
+                    T pixel = distances(x, y);
+                    float med = median(pixel.r, pixel.g, pixel.b);
+                    pixel.r = med, pixel.g = med, pixel.b = med;
+                    convertPixel(output(x, y), pixel);
+                } else if (!inPlace)
+                    convertPixel(output(x, y), distances(x, y));
+    }
+
+private:
+    BitmapRef<T> distances;
+    BitmapRef<O> output;
+    const std::vector<char> &clashes;
+    bool inPlace;
+
+};
 
-                output(x, row) = float(sd/range+.5);
+/** Marks the filled pixels of a tile of rows that may take part in a clash, which are those whose channels are not on
+ *  the same side of .5 as those of all of their neighbors. The clash test ignores the values of the other pixels.
+ */
+template <typename T>
+class SaturationBoundaryJob : public ThreadPool::Job {
+
+public:
+    SaturationBoundaryJob(const BitmapRef<T> &output, std::vector<char> &filled) : output(output), filled(filled) { }
+    void execute(int task) {
+        int w = output.width(), h = output.height();
+        for (int y = task*MSDFGEN_ROW_TILE_HEIGHT, end = min(y+MSDFGEN_ROW_TILE_HEIGHT, h); y < end; ++y)
+            for (int x = 0; x < w; ++x) {
+                if (!filled[w*y+x])
+                    continue;
+                int above = ChannelSides(output(x, y)).above;
+                if ((x > 0 && ChannelSides(output(x-1, y)).above != above)
+                    || (x < w-1 && ChannelSides(output(x+1, y)).above != above)
+                    || (y > 0 && ChannelSides(output(x, y-1)).above != above)
+                    || (y < h-1 && ChannelSides(output(x, y+1)).above != above))
+                    filled[w*y+x] = 2;
             }
+    }
+
+private:
+    BitmapRef<T> output;
+    std::vector<char> &filled;
+
+};
+
+/// Evaluates the pixels of a tile of rows marked by SaturationBoundaryJob exactly.
+template <typename T>
+class SaturationRefinementJob : public ThreadPool::Job {
+
+public:
+    SaturationRefinementJob(typename PixelFunction<T>::Type pixelFunction, const BitmapRef<T> &output, const GeneratorContext &context, const std::vector<char> &filled) : pixelFunction(pixelFunction), output(output), context(context), filled(filled) { }
+    void execute(int task) {
+        int w = output.width(), h = output.height();
+        for (int row = task*MSDFGEN_ROW_TILE_HEIGHT, end = min(row+MSDFGEN_ROW_TILE_HEIGHT, h); row < end; ++row) {
+            int y = context.shape.inverseYAxis ? h-row-1 : row;
+            for (int x = 0; x < w; ++x)
+                if (filled[w*row+x] == 2)
+                    (*pixelFunction)(output, context, x, y, x+1, y+1);
         }
     }
+
+private:
+    typename PixelFunction<T>::Type pixelFunction;
+    BitmapRef<T> output;
+    const GeneratorContext &context;
+    const std::vector<char> &filled;
+
+};
+
+/// Corrects the clashes of a floating-point multi-channel distance field and stores it in the output, which may be the distance field itself.
+template <typename T, typename O>
+static void msdfErrorCorrection(const BitmapRef<T> &distances, const BitmapRef<O> &output, const Vector2 &threshold) {
+    if (!distances.width() || !distances.height())
+        return;
+    int tiles = (distances.height()+MSDFGEN_ROW_TILE_HEIGHT-1)/MSDFGEN_ROW_TILE_HEIGHT;
+    // All clashes must be detected before any pixel is corrected
+    std::vector<char> clashes(distances.width()*distances.height());
+    ClashDetectionJob<T> detection(distances, threshold, clashes);
+    ThreadPool::shared().run(detection, tiles);
+    bool inPlace = (const void *) &distances(0, 0) == (const void *) &output(0, 0);
+    ClashCorrectionJob<T, O> correction(distances, output, clashes, inPlace);
+    ThreadPool::shared().run(correction, tiles);
 }
 
-void generatePseudoSDF(Bitmap<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
-    int contourCount = shape.contours.size();
-    int w = output.width(), h = output.height();
-    std::vector<int> windings;
-    windings.reserve(contourCount);
-    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
-        windings.push_back(contour->winding());
-
-#ifdef MSDFGEN_USE_OPENMP
-    #pragma omp parallel
-#endif
-    {
-        std::vector<double> contourSD;
-        contourSD.resize(contourCount);
-#ifdef MSDFGEN_USE_OPENMP
-        #pragma omp for
-#endif
-        for (int y = 0; y < h; ++y) {
-            int row = shape.inverseYAxis ? h-y-1 : y;
-            for (int x = 0; x < w; ++x) {
-                Point2 p = Vector2(x+.5, y+.5)/scale-translate;
-                double sd = SignedDistance::INFINITE.distance;
-                double negDist = -SignedDistance::INFINITE.distance;
-                double posDist = SignedDistance::INFINITE.distance;
-                int winding = 0;
-
-                std::vector<Contour>::const_iterator contour = shape.contours.begin();
-                for (int i = 0; i < contourCount; ++i, ++contour) {
-                    SignedDistance minDistance;
-                    const EdgeHolder *nearEdge = NULL;
-                    double nearParam = 0;
-                    for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
-                        double param;
-                        SignedDistance distance = (*edge)->signedDistance(p, param);
-                        if (distance < minDistance) {
-                            minDistance = distance;
-                            nearEdge = &*edge;
-                            nearParam = param;
-                        }
-                    }
-                    if (fabs(minDistance.distance) < fabs(sd)) {
-                        sd = minDistance.distance;
-                        winding = -windings[i];
-                    }
-                    if (nearEdge)
-                        (*nearEdge)->distanceToPseudoDistance(minDistance, p, nearParam);
-                    contourSD[i] = minDistance.distance;
-                    if (windings[i] > 0 && minDistance.distance >= 0 && fabs(minDistance.distance) < fabs(posDist))
-                        posDist = minDistance.distance;
-                    if (windings[i] < 0 && minDistance.distance <= 0 && fabs(minDistance.distance) < fabs(negDist))
-                        negDist = minDistance.distance;
-                }
+/// A temporary bitmap, whose storage is taken from the shared pool and returned to it once the bitmap goes out of scope.
+template <typename T>
+struct PooledBitmap {
+    Bitmap<T> bitmap;
+    ~PooledBitmap() {
+        BitmapPool<T>::shared().release(bitmap);
+    }
+};
 
-                double psd = SignedDistance::INFINITE.distance;
-                if (posDist >= 0 && fabs(posDist) <= fabs(negDist)) {
-                    psd = posDist;
-                    winding = 1;
-                    for (int i = 0; i < contourCount; ++i)
-                        if (windings[i] > 0 && contourSD[i] > psd && fabs(contourSD[i]) < fabs(negDist))
-                            psd = contourSD[i];
-                } else if (negDist <= 0 && fabs(negDist) <= fabs(posDist)) {
-                    psd = negDist;
-                    winding = -1;
-                    for (int i = 0; i < contourCount; ++i)
-                        if (windings[i] < 0 && contourSD[i] < psd && fabs(contourSD[i]) < fabs(posDist))
-                            psd = contourSD[i];
-                }
-                for (int i = 0; i < contourCount; ++i)
-                    if (windings[i] != winding && fabs(contourSD[i]) < fabs(psd))
-                        psd = contourSD[i];
+/** Returns the floating-point bitmap that a multi-channel distance field is generated in before error correction, which is
+ *  the output itself if it is of the same type, or the temporary bitmap, acquired in the size of the output, otherwise.
+ */
+template <typename T>
+static BitmapRef<T> distanceBuffer(const BitmapRef<T> &output, PooledBitmap<T> &) {
+    return output;
+}
 
-                output(x, row) = float(psd/range+.5);
+template <typename T, typename O>
+static BitmapRef<T> distanceBuffer(const BitmapRef<O> &output, PooledBitmap<T> &buffer) {
+    BitmapPool<T>::shared().acquire(buffer.bitmap, output.width(), output.height());
+    return buffer.bitmap;
+}
+
+void setThreadCount(int threadCount) {
+    ThreadPool::setSharedThreadCount(threadCount);
+}
+
+double measureKernelDeviation(const EdgeKernels &kernels, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, int width, int height, double *pseudoDeviation) {
+    FlatShape flat(shape);
+    double maxDeviation = 0, maxPseudoDeviation = 0;
+    for (int edge = 0; edge < flat.edgeCount(); ++edge) {
+        int i = flat.edgeOffsets[edge];
+        SignedDistance distances[MSDFGEN_DISTANCE_BATCH];
+        double params[MSDFGEN_DISTANCE_BATCH];
+        // Edges without a kernel are evaluated by the scalar path
+        PixelBatch probe(0, 0, width, scale, translate);
+        bool supported = false;
+        switch (flat.edgeTypes[edge]) {
+            case FlatShape::LINEAR:
+                supported = kernels.linearSignedDistance(&flat.linearPoints[2*i], flat.linearTerms[i], probe.x, probe.y, distances, params);
+                break;
+            case FlatShape::QUADRATIC:
+                supported = kernels.quadraticSignedDistance(&flat.quadraticPoints[3*i], flat.quadraticTerms[i], probe.x, probe.y, distances, params);
+                break;
+        }
+        if (!supported)
+            continue;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; x += MSDFGEN_DISTANCE_BATCH) {
+                PixelBatch batch(x, y, width, scale, translate);
+                if (flat.edgeTypes[edge] == FlatShape::LINEAR)
+                    kernels.linearSignedDistance(&flat.linearPoints[2*i], flat.linearTerms[i], batch.x, batch.y, distances, params);
+                else
+                    kernels.quadraticSignedDistance(&flat.quadraticPoints[3*i], flat.quadraticTerms[i], batch.x, batch.y, distances, params);
+                for (int j = 0; j < batch.count; ++j) {
+                    double param;
+                    Point2 p = batch.point(j);
+                    SignedDistance reference = flat.signedDistance(edge, p, param);
+                    // Only distances within the range affect the output
+                    if (fabs(reference.distance) <= .5*range)
+                        maxDeviation = max(maxDeviation, fabs(distances[j].distance-reference.distance));
+                    // The pseudo-distances also depend on the params, which select the extension of the edge beyond its endpoints
+                    SignedDistance pseudo = distances[j];
+                    flat.distanceToPseudoDistance(edge, pseudo, p, params[j]);
+                    flat.distanceToPseudoDistance(edge, reference, p, param);
+                    if (fabs(reference.distance) <= .5*range)
+                        maxPseudoDeviation = max(maxPseudoDeviation, fabs(pseudo.distance-reference.distance));
+                }
             }
         }
     }
+    double pixelScale = max(fabs(scale.x), fabs(scale.y));
+    if (pseudoDeviation)
+        *pseudoDeviation = maxPseudoDeviation*pixelScale;
+    return maxDeviation*pixelScale;
 }
 
-void generateMSDF(Bitmap<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
-    int contourCount = shape.contours.size();
-    int w = output.width(), h = output.height();
-    std::vector<int> windings;
-    windings.reserve(contourCount);
-    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
-        windings.push_back(contour->winding());
-
-#ifdef MSDFGEN_USE_OPENMP
-    #pragma omp parallel
-#endif
-    {
-        std::vector<MultiDistance> contourSD;
-        contourSD.resize(contourCount);
-#ifdef MSDFGEN_USE_OPENMP
-        #pragma omp for
-#endif
-        for (int y = 0; y < h; ++y) {
-            int row = shape.inverseYAxis ? h-y-1 : y;
-            for (int x = 0; x < w; ++x) {
-                Point2 p = Vector2(x+.5, y+.5)/scale-translate;
-
-                struct EdgePoint {
-                    SignedDistance minDistance;
-                    const EdgeHolder *nearEdge;
-                    double nearParam;
-                } sr, sg, sb;
-                sr.nearEdge = sg.nearEdge = sb.nearEdge = NULL;
-                sr.nearParam = sg.nearParam = sb.nearParam = 0;
-                double d = fabs(SignedDistance::INFINITE.distance);
-                double negDist = -SignedDistance::INFINITE.distance;
-                double posDist = SignedDistance::INFINITE.distance;
-                int winding = 0;
-
-                std::vector<Contour>::const_iterator contour = shape.contours.begin();
-                for (int i = 0; i < contourCount; ++i, ++contour) {
-                    EdgePoint r, g, b;
-                    r.nearEdge = g.nearEdge = b.nearEdge = NULL;
-                    r.nearParam = g.nearParam = b.nearParam = 0;
-
-                    for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
-                        double param;
-                        SignedDistance distance = (*edge)->signedDistance(p, param);
-                        if ((*edge)->color&RED && distance < r.minDistance) {
-                            r.minDistance = distance;
-                            r.nearEdge = &*edge;
-                            r.nearParam = param;
-                        }
-                        if ((*edge)->color&GREEN && distance < g.minDistance) {
-                            g.minDistance = distance;
-                            g.nearEdge = &*edge;
-                            g.nearParam = param;
-                        }
-                        if ((*edge)->color&BLUE && distance < b.minDistance) {
-                            b.minDistance = distance;
-                            b.nearEdge = &*edge;
-                            b.nearParam = param;
-                        }
-                    }
-                    if (r.minDistance < sr.minDistance)
-                        sr = r;
-                    if (g.minDistance < sg.minDistance)
-                        sg = g;
-                    if (b.minDistance < sb.minDistance)
-                        sb = b;
-
-                    double medMinDistance = fabs(median(r.minDistance.distance, g.minDistance.distance, b.minDistance.distance));
-                    if (medMinDistance < d) {
-                        d = medMinDistance;
-                        winding = -windings[i];
-                    }
-                    if (r.nearEdge)
-                        (*r.nearEdge)->distanceToPseudoDistance(r.minDistance, p, r.nearParam);
-                    if (g.nearEdge)
-                        (*g.nearEdge)->distanceToPseudoDistance(g.minDistance, p, g.nearParam);
-                    if (b.nearEdge)
-                        (*b.nearEdge)->distanceToPseudoDistance(b.minDistance, p, b.nearParam);
-                    medMinDistance = median(r.minDistance.distance, g.minDistance.distance, b.minDistance.distance);
-                    contourSD[i].r = r.minDistance.distance;
-                    contourSD[i].g = g.minDistance.distance;
-                    contourSD[i].b = b.minDistance.distance;
-                    contourSD[i].med = medMinDistance;
-                    if (windings[i] > 0 && medMinDistance >= 0 && fabs(medMinDistance) < fabs(posDist))
-                        posDist = medMinDistance;
-                    if (windings[i] < 0 && medMinDistance <= 0 && fabs(medMinDistance) < fabs(negDist))
-                        negDist = medMinDistance;
-                }
-                if (sr.nearEdge)
-                    (*sr.nearEdge)->distanceToPseudoDistance(sr.minDistance, p, sr.nearParam);
-                if (sg.nearEdge)
-                    (*sg.nearEdge)->distanceToPseudoDistance(sg.minDistance, p, sg.nearParam);
-                if (sb.nearEdge)
-                    (*sb.nearEdge)->distanceToPseudoDistance(sb.minDistance, p, sb.nearParam);
-
-                MultiDistance msd;
-                msd.r = msd.g = msd.b = msd.med = SignedDistance::INFINITE.distance;
-                if (posDist >= 0 && fabs(posDist) <= fabs(negDist)) {
-                    msd.med = SignedDistance::INFINITE.distance;
-                    winding = 1;
-                    for (int i = 0; i < contourCount; ++i)
-                        if (windings[i] > 0 && contourSD[i].med > msd.med && fabs(contourSD[i].med) < fabs(negDist))
-                            msd = contourSD[i];
-                } else if (negDist <= 0 && fabs(negDist) <= fabs(posDist)) {
-                    msd.med = -SignedDistance::INFINITE.distance;
-                    winding = -1;
-                    for (int i = 0; i < contourCount; ++i)
-                        if (windings[i] < 0 && contourSD[i].med < msd.med && fabs(contourSD[i].med) < fabs(posDist))
-                            msd = contourSD[i];
-                }
-                for (int i = 0; i < contourCount; ++i)
-                    if (windings[i] != winding && fabs(contourSD[i].med) < fabs(msd.med))
-                        msd = contourSD[i];
-                if (median(sr.minDistance.distance, sg.minDistance.distance, sb.minDistance.distance) == msd.med) {
-                    msd.r = sr.minDistance.distance;
-                    msd.g = sg.minDistance.distance;
-                    msd.b = sb.minDistance.distance;
-                }
+/// Distance selector of signed distance fields: the true distance to the nearest edge.
+struct TrueDistanceSelector {
+    typedef float Pixel;
+    typedef NearestEdgeQuery Query;
+    static const int channels = 1;
+    static const bool pseudo = false;
 
-                output(x, row).r = float(msd.r/range+.5);
-                output(x, row).g = float(msd.g/range+.5);
-                output(x, row).b = float(msd.b/range+.5);
-            }
+    static void distances(double *distances, Query &query, int i, const FlatShape &, Point2) {
+        distances[0] = query.nearest[i].minDistance.distance;
+    }
+};
+
+/// Distance selector of pseudo-distance fields: the pseudo-distance to the nearest edge.
+struct PseudoDistanceSelector {
+    typedef float Pixel;
+    typedef NearestEdgeQuery Query;
+    static const int channels = 1;
+    static const bool pseudo = true;
+
+    static void distances(double *distances, Query &query, int i, const FlatShape &shape, Point2 p) {
+        toPseudoDistance(query.nearest[i], shape, p);
+        distances[0] = query.nearest[i].minDistance.distance;
+    }
+};
+
+/// Distance selector of multi-channel distance fields: the pseudo-distance to the nearest edge of each color channel.
+struct MultiDistanceSelector {
+    typedef FloatRGB Pixel;
+    typedef NearestEdgeColorQuery<false> Query;
+    static const int channels = 3;
+    static const bool pseudo = true;
+
+    static void distances(double *distances, Query &query, int i, const FlatShape &shape, Point2 p) {
+        toPseudoDistance(query.r[i], shape, p);
+        toPseudoDistance(query.g[i], shape, p);
+        toPseudoDistance(query.b[i], shape, p);
+        distances[0] = query.r[i].minDistance.distance;
+        distances[1] = query.g[i].minDistance.distance;
+        distances[2] = query.b[i].minDistance.distance;
+    }
+};
+
+/// Distance selector of multi-channel and true distance fields: the multi-channel distances plus the true distance to the nearest edge.
+struct MultiAndTrueDistanceSelector {
+    typedef FloatRGBA Pixel;
+    typedef NearestEdgeColorQuery<true> Query;
+    static const int channels = 4;
+    static const bool pseudo = true;
+
+    static void distances(double *distances, Query &query, int i, const FlatShape &shape, Point2 p) {
+        toPseudoDistance(query.r[i], shape, p);
+        toPseudoDistance(query.g[i], shape, p);
+        toPseudoDistance(query.b[i], shape, p);
+        distances[0] = query.r[i].minDistance.distance;
+        distances[1] = query.g[i].minDistance.distance;
+        distances[2] = query.b[i].minDistance.distance;
+        distances[3] = query.nearest[i].minDistance.distance;
+    }
+};
+
+/// Signs the distances of a pixel according to the scanline. The first channel is a true or pseudo-distance if N is 1,
+/// otherwise the first three are multi-channel distances, optionally followed by a true distance.
+template <int N>
+static inline void applyFillSign(double *distances, bool filled) {
+    if (N == 1)
+        distances[0] = filled ? fabs(distances[0]) : -fabs(distances[0]);
+    else {
+        double med = median(distances[0], distances[1], distances[2]);
+        // Where the median contradicts the scanline, such as inside overlapping contours, all channels are negated
+        if ((med > 0) != filled && med != 0) {
+            for (int i = 0; i < 3; ++i)
+                distances[i] = -distances[i];
         }
+        if (N == 4)
+            distances[3] = filled ? fabs(distances[3]) : -fabs(distances[3]);
     }
+}
 
-    if (edgeThreshold > 0)
-        msdfErrorCorrection(output, edgeThreshold/(scale*range));
-}
-
-void generateSDF_legacy(Bitmap<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
-    int w = output.width(), h = output.height();
-#ifdef MSDFGEN_USE_OPENMP
-    #pragma omp parallel for
-#endif
-    for (int y = 0; y < h; ++y) {
-        int row = shape.inverseYAxis ? h-y-1 : y;
-        for (int x = 0; x < w; ++x) {
-            double dummy;
-            Point2 p = Vector2(x+.5, y+.5)/scale-translate;
-            SignedDistance minDistance;
-            for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
-                for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
-                    SignedDistance distance = (*edge)->signedDistance(p, dummy);
-                    if (distance < minDistance)
-                        minDistance = distance;
-                }
-            output(x, row) = float(minDistance.distance/range+.5);
+/** Computes the pixels of a distance field by querying the edge trees of the shape for each batch of pixels.
+ *  The selector determines the nearest edges and the channel distances of a pixel at compile time.
+ *  The signs are given by the scanlines, or by the nearest edges themselves in legacy mode.
+ */
+template <class Selector, bool legacy, typename T>
+static void generatePixels(const BitmapRef<T> &output, const GeneratorContext &context, int x0, int y0, int x1, int y1) {
+    const FlatShape &flat = context.shape;
+    int contourCount = flat.contourCount();
+    int h = output.height();
+    for (int y = y0; y < y1; ++y) {
+        int row = flat.inverseYAxis ? h-y-1 : y;
+        for (int x = x0; x < x1; x += MSDFGEN_DISTANCE_BATCH) {
+            PixelBatch batch(x, y, x1, context.scale, context.translate);
+            typename Selector::Query query(flat, batch.x, batch.y);
+            for (int i = 0; i < contourCount; ++i)
+                context.trees[i].query(batch.lo, batch.hi, query);
+            for (int j = 0; j < batch.count; ++j) {
+                Point2 p = batch.point(j);
+                double distances[Selector::channels];
+                Selector::distances(distances, query, j, flat, p);
+                if (!legacy)
+                    applyFillSign<Selector::channels>(distances, context.scanlines[y].filled(p.x, context.fillRule));
+                storePixel(output(x+j, row), distances, context.range);
+            }
         }
     }
 }
 
-void generatePseudoSDF_legacy(Bitmap<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
-    int w = output.width(), h = output.height();
-#ifdef MSDFGEN_USE_OPENMP
-    #pragma omp parallel for
-#endif
-    for (int y = 0; y < h; ++y) {
-        int row = shape.inverseYAxis ? h-y-1 : y;
-        for (int x = 0; x < w; ++x) {
-            Point2 p = Vector2(x+.5, y+.5)/scale-translate;
-            SignedDistance minDistance;
-            const EdgeHolder *nearEdge = NULL;
-            double nearParam = 0;
-            for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
-                for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
-                    double param;
-                    SignedDistance distance = (*edge)->signedDistance(p, param);
-                    if (distance < minDistance) {
-                        minDistance = distance;
-                        nearEdge = &*edge;
-                        nearParam = param;
-                    }
-                }
-            if (nearEdge)
-                (*nearEdge)->distanceToPseudoDistance(minDistance, p, nearParam);
-            output(x, row) = float(minDistance.distance/range+.5);
+/// Generates a distance field signed by the scanlines. If skipSaturated is set, the pixels filled without evaluation are marked in filled.
+template <class Selector, typename T>
+static void generateDistanceField(const BitmapRef<T> &output, GeneratorContext &context, bool skipSaturated, std::vector<char> &filled) {
+    computeScanlines(context, output.height());
+    if (skipSaturated)
+        generateQuadtree(&generatePixels<Selector, false, T>, Selector::pseudo, Selector::channels > 1, output, context, filled);
+    else
+        generateRowTiles(&generatePixels<Selector, false, T>, output, context);
+}
+
+void generateSDF(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    generateSDF(output, PreparedShape(shape), range, scale, translate, skipSaturated, fillRule);
+}
+
+template <typename T>
+static void generateSDF(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    GeneratorContext context(shape, range, scale, translate, fillRule);
+    std::vector<char> filled;
+    generateDistanceField<TrueDistanceSelector>(output, context, skipSaturated, filled);
+}
+
+void generateSDF(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    generateSDF<float>(output, shape, range, scale, translate, skipSaturated, fillRule);
+}
+
+void generatePseudoSDF(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    generatePseudoSDF(output, PreparedShape(shape), range, scale, translate, skipSaturated, fillRule);
+}
+
+template <typename T>
+static void generatePseudoSDF(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    GeneratorContext context(shape, range, scale, translate, fillRule);
+    std::vector<char> filled;
+    generateDistanceField<PseudoDistanceSelector>(output, context, skipSaturated, filled);
+}
+
+void generatePseudoSDF(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    generatePseudoSDF<float>(output, shape, range, scale, translate, skipSaturated, fillRule);
+}
+
+void generateMSDF(const BitmapRef<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMSDF(output, PreparedShape(shape), range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+/// Generates a distance field with multi-channel distances signed by the scanlines and corrects their clashes.
+template <class Selector, typename T>
+static void generateMultiDistanceField(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    typedef typename Selector::Pixel Pixel;
+    GeneratorContext context(shape, range, scale, translate, fillRule);
+    std::vector<char> filled;
+    if (edgeThreshold <= 0) {
+        generateDistanceField<Selector>(output, context, skipSaturated, filled);
+        return;
+    }
+    // The clash test compares floating-point distances, so other output types are only stored after error correction
+    PooledBitmap<Pixel> buffer;
+    BitmapRef<Pixel> distances = distanceBuffer(output, buffer);
+    generateDistanceField<Selector>(distances, context, skipSaturated, filled);
+    // Filled pixels must not change the outcome of the clash test, so any that it may depend on are evaluated exactly
+    if (skipSaturated) {
+        int tiles = (distances.height()+MSDFGEN_ROW_TILE_HEIGHT-1)/MSDFGEN_ROW_TILE_HEIGHT;
+        SaturationBoundaryJob<Pixel> boundary(distances, filled);
+        ThreadPool::shared().run(boundary, tiles);
+        SaturationRefinementJob<Pixel> refinement(&generatePixels<Selector, false, Pixel>, distances, context, filled);
+        ThreadPool::shared().run(refinement, tiles);
+    }
+    msdfErrorCorrection(distances, output, edgeThreshold/(scale*range));
+}
+
+template <typename T>
+static void generateMSDF(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMultiDistanceField<MultiDistanceSelector>(output, shape, range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+void generateMSDF(const BitmapRef<FloatRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMSDF<FloatRGB>(output, shape, range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+void generateMTSDF(const BitmapRef<FloatRGBA> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMTSDF(output, PreparedShape(shape), range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+template <typename T>
+static void generateMTSDF(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMultiDistanceField<MultiAndTrueDistanceSelector>(output, shape, range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+void generateMTSDF(const BitmapRef<FloatRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMTSDF<FloatRGBA>(output, shape, range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+void generateSDF_legacy(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    generateSDF_legacy(output, PreparedShape(shape), range, scale, translate);
+}
+
+template <typename T>
+static void generateSDF_legacy(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    GeneratorContext context(shape, range, scale, translate);
+    generateRowTiles(&generatePixels<TrueDistanceSelector, true, T>, output, context);
+}
+
+void generateSDF_legacy(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    generateSDF_legacy<float>(output, shape, range, scale, translate);
+}
+
+void generatePseudoSDF_legacy(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    generatePseudoSDF_legacy(output, PreparedShape(shape), range, scale, translate);
+}
+
+template <typename T>
+static void generatePseudoSDF_legacy(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    GeneratorContext context(shape, range, scale, translate);
+    generateRowTiles(&generatePixels<PseudoDistanceSelector, true, T>, output, context);
+}
+
+void generatePseudoSDF_legacy(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    generatePseudoSDF_legacy<float>(output, shape, range, scale, translate);
+}
+
+/// Generates a multi-channel distance field signed by the nearest edges and corrects its clashes.
+template <class Selector, typename T>
+static void generateLegacyMultiDistanceField(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    typedef typename Selector::Pixel Pixel;
+    GeneratorContext context(shape, range, scale, translate);
+    if (edgeThreshold <= 0) {
+        generateRowTiles(&generatePixels<Selector, true, T>, output, context);
+        return;
+    }
+    PooledBitmap<Pixel> buffer;
+    BitmapRef<Pixel> distances = distanceBuffer(output, buffer);
+    generateRowTiles(&generatePixels<Selector, true, Pixel>, distances, context);
+    msdfErrorCorrection(distances, output, edgeThreshold/(scale*range));
+}
+
+void generateMSDF_legacy(const BitmapRef<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateMSDF_legacy(output, PreparedShape(shape), range, scale, translate, edgeThreshold);
+}
+
+template <typename T>
+static void generateMSDF_legacy(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateLegacyMultiDistanceField<MultiDistanceSelector>(output, shape, range, scale, translate, edgeThreshold);
+}
+
+void generateMSDF_legacy(const BitmapRef<FloatRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateMSDF_legacy<FloatRGB>(output, shape, range, scale, translate, edgeThreshold);
+}
+
+void generateMTSDF_legacy(const BitmapRef<FloatRGBA> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateMTSDF_legacy(output, PreparedShape(shape), range, scale, translate, edgeThreshold);
+}
+
+template <typename T>
+static void generateMTSDF_legacy(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateLegacyMultiDistanceField<MultiAndTrueDistanceSelector>(output, shape, range, scale, translate, edgeThreshold);
+}
+
+void generateMTSDF_legacy(const BitmapRef<FloatRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateMTSDF_legacy<FloatRGBA>(output, shape, range, scale, translate, edgeThreshold);
+}
+
+/// The part of an edge's band of pixels closer than half the range, bounded by the dilated bounding box of a part of the edge.
+struct EdgeBand {
+    int edge;
+    /// The range of pixels from x0, y0 to x1, y1 (exclusive).
+    int x0, y0, x1, y1;
+};
+
+/// The shape and parameters of an edge-major generator and the edge bands that overlap each row tile, ordered by edge.
+struct EdgeBandContext {
+    const FlatShape &shape;
+    double range;
+    Vector2 scale, translate;
+    FillRule fillRule;
+    std::vector<std::vector<EdgeBand> > tiles;
+
+    EdgeBandContext(const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, int width, int height);
+};
+
+/// Replaces the control points of a Bezier curve by those of its part before (or after) t.
+static void splitBezier(Point2 *p, int degree, double t, bool keepFirst) {
+    Point2 q[4];
+    for (int i = 0; i <= degree; ++i)
+        q[i] = p[i];
+    for (int n = degree; n > 0; --n) {
+        if (keepFirst)
+            p[degree-n] = q[0];
+        else
+            p[n] = q[n];
+        for (int i = 0; i < n; ++i)
+            q[i] = mix(q[i], q[i+1], t);
+    }
+    p[keepFirst ? degree : 0] = q[0];
+}
+
+/// Computes the range of pixels whose centers lie between lo and hi along one axis.
+static void pixelRange(int &begin, int &end, double lo, double hi, double scale, double translate, int size) {
+    double a = (lo+translate)*scale-.5, b = (hi+translate)*scale-.5;
+    if (b < a) {
+        double tmp = a;
+        a = b;
+        b = tmp;
+    }
+    begin = int(ceil(clamp(a-1e-6, -1., size+1.)));
+    end = int(floor(clamp(b+1e-6, -1., size+1.)))+1;
+    begin = max(begin, 0);
+    end = min(end, size);
+}
+
+EdgeBandContext::EdgeBandContext(const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule, int width, int height) : shape(shape.shape), range(range), scale(scale), translate(translate), fillRule(fillRule) {
+    tiles.resize((height+MSDFGEN_ROW_TILE_HEIGHT-1)/MSDFGEN_ROW_TILE_HEIGHT);
+    double radius = .5*range;
+    // Parts of about the size of the radius keep the dilated boxes close to the actual band
+    double partLength = max(radius, 1/min(fabs(scale.x), fabs(scale.y)));
+    int edgeCount = this->shape.edgeCount();
+    for (int edge = 0; edge < edgeCount; ++edge) {
+        const Point2 *p;
+        int degree = this->shape.controlPoints(edge, p);
+        double length = 0;
+        for (int i = 0; i < degree; ++i)
+            length += (p[i+1]-p[i]).length();
+        int parts = int(clamp(ceil(length/partLength), 1., double(MSDFGEN_EDGE_BAND_MAX_PARTS)));
+        for (int i = 0; i < parts; ++i) {
+            Point2 q[4];
+            for (int j = 0; j <= degree; ++j)
+                q[j] = p[j];
+            if (i+1 < parts)
+                splitBezier(q, degree, double(i+1)/parts, true);
+            if (i > 0)
+                splitBezier(q, degree, double(i)/(i+1), false);
+            // The part lies within the convex hull of its control points
+            Point2 lo = q[0], hi = q[0];
+            for (int j = 1; j <= degree; ++j) {
+                lo.x = min(lo.x, q[j].x), lo.y = min(lo.y, q[j].y);
+                hi.x = max(hi.x, q[j].x), hi.y = max(hi.y, q[j].y);
+            }
+            EdgeBand band;
+            band.edge = edge;
+            pixelRange(band.x0, band.x1, lo.x-radius, hi.x+radius, scale.x, translate.x, width);
+            pixelRange(band.y0, band.y1, lo.y-radius, hi.y+radius, scale.y, translate.y, height);
+            if (band.x0 >= band.x1 || band.y0 >= band.y1)
+                continue;
+            for (int tile = band.y0/MSDFGEN_ROW_TILE_HEIGHT; tile <= (band.y1-1)/MSDFGEN_ROW_TILE_HEIGHT; ++tile)
+                tiles[tile].push_back(band);
         }
     }
 }
 
-void generateMSDF_legacy(Bitmap<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
-    int w = output.width(), h = output.height();
-#ifdef MSDFGEN_USE_OPENMP
-    #pragma omp parallel for
-#endif
-    for (int y = 0; y < h; ++y) {
-        int row = shape.inverseYAxis ? h-y-1 : y;
-        for (int x = 0; x < w; ++x) {
-            Point2 p = Vector2(x+.5, y+.5)/scale-translate;
+/** Generates a row tile of a distance field edge by edge. Each edge only updates the nearest edges of the pixels in its band,
+ *  afterwards the sign of each pixel is resolved by the scanline of its row.
+ *  Pixels without an edge closer than half the range are saturated.
+ */
+template <class Selector, typename T>
+class EdgeMajorJob : public ThreadPool::Job {
 
-            struct {
-                SignedDistance minDistance;
-                const EdgeHolder *nearEdge;
-                double nearParam;
-            } r, g, b;
-            r.nearEdge = g.nearEdge = b.nearEdge = NULL;
-            r.nearParam = g.nearParam = b.nearParam = 0;
+public:
+    EdgeMajorJob(const BitmapRef<T> &output, const EdgeBandContext &context) : output(output), context(context) { }
+    void execute(int task) {
+        const FlatShape &flat = context.shape;
+        const std::vector<EdgeBand> &bands = context.tiles[task];
+        int w = output.width(), h = output.height();
+        int y0 = task*MSDFGEN_ROW_TILE_HEIGHT, y1 = min(y0+MSDFGEN_ROW_TILE_HEIGHT, h);
+        std::vector<EdgePoint> nearest(channels*w*(y1-y0));
+        for (std::vector<EdgePoint>::iterator point = nearest.begin(); point != nearest.end(); ++point)
+            resetEdgePoint(*point);
 
-            for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
-                for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
-                    double param;
-                    SignedDistance distance = (*edge)->signedDistance(p, param);
-                    if ((*edge)->color&RED && distance < r.minDistance) {
-                        r.minDistance = distance;
-                        r.nearEdge = &*edge;
-                        r.nearParam = param;
-                    }
-                    if ((*edge)->color&GREEN && distance < g.minDistance) {
-                        g.minDistance = distance;
-                        g.nearEdge = &*edge;
-                        g.nearParam = param;
-                    }
-                    if ((*edge)->color&BLUE && distance < b.minDistance) {
-                        b.minDistance = distance;
-                        b.nearEdge = &*edge;
-                        b.nearParam = param;
+        std::vector<std::pair<int, int> > spans;
+        for (int y = y0; y < y1; ++y) {
+            EdgePoint *rowNearest = &nearest[channels*w*(y-y0)];
+            for (int i = 0; i < (int) bands.size();) {
+                // Merge the parts of the edge's band in this row, so that no pixel is evaluated twice
+                int edge = bands[i].edge;
+                spans.clear();
+                for (; i < (int) bands.size() && bands[i].edge == edge; ++i)
+                    if (y >= bands[i].y0 && y < bands[i].y1)
+                        spans.push_back(std::make_pair(bands[i].x0, bands[i].x1));
+                std::sort(spans.begin(), spans.end());
+                // All edges belong to the channel of the true distance
+                int color = channels == 1 ? RED : flat.edgeColors[edge]|(channels > 3 ? 1<<3 : 0);
+                for (int j = 0; j < (int) spans.size();) {
+                    int x0 = spans[j].first, x1 = spans[j].second;
+                    for (++j; j < (int) spans.size() && spans[j].first <= x1; ++j)
+                        x1 = max(x1, spans[j].second);
+                    for (int x = x0; x < x1; x += MSDFGEN_DISTANCE_BATCH) {
+                        PixelBatch batch(x, y, x1, context.scale, context.translate);
+                        SignedDistance distances[MSDFGEN_DISTANCE_BATCH];
+                        double params[MSDFGEN_DISTANCE_BATCH];
+                        flat.signedDistanceBatch(edge, batch.x, batch.y, distances, params);
+                        for (int k = 0; k < batch.count; ++k) {
+                            // Edges are processed in order, so ties are resolved in favor of the lower index
+                            EdgePoint *pixelNearest = rowNearest+channels*(x+k);
+                            for (int c = 0; c < channels; ++c)
+                                if (color&(1<<c) && distances[k] < pixelNearest[c].minDistance) {
+                                    pixelNearest[c].minDistance = distances[k];
+                                    pixelNearest[c].nearParam = params[k];
+                                    pixelNearest[c].nearEdge = edge;
+                                }
+                        }
                     }
                 }
+            }
+        }
 
-            if (r.nearEdge)
-                (*r.nearEdge)->distanceToPseudoDistance(r.minDistance, p, r.nearParam);
-            if (g.nearEdge)
-                (*g.nearEdge)->distanceToPseudoDistance(g.minDistance, p, g.nearParam);
-            if (b.nearEdge)
-                (*b.nearEdge)->distanceToPseudoDistance(b.minDistance, p, b.nearParam);
-            output(x, row).r = float(r.minDistance.distance/range+.5);
-            output(x, row).g = float(g.minDistance.distance/range+.5);
-            output(x, row).b = float(b.minDistance.distance/range+.5);
+        double radius = .5*context.range;
+        Scanline scanline;
+        for (int y = y0; y < y1; ++y) {
+            int row = flat.inverseYAxis ? h-y-1 : y;
+            flat.scanline(scanline, (y+.5)/context.scale.y-context.translate.y);
+            EdgePoint *rowNearest = &nearest[channels*w*(y-y0)];
+            for (int x = 0; x < w; ++x) {
+                Point2 p = Vector2(x+.5, y+.5)/context.scale-context.translate;
+                double fillSign = scanline.filled(p.x, context.fillRule) ? 1 : -1;
+                double distances[channels];
+                bool inBand[channels];
+                for (int c = 0; c < channels; ++c) {
+                    EdgePoint &pixelNearest = rowNearest[channels*x+c];
+                    inBand[c] = pixelNearest.nearEdge >= 0 && fabs(pixelNearest.minDistance.distance) <= radius;
+                    if (inBand[c]) {
+                        // The channel following the color channels holds the true distance
+                        if (Selector::pseudo && c < 3)
+                            toPseudoDistance(pixelNearest, flat, p);
+                        distances[c] = pixelNearest.minDistance.distance;
+                    } else
+                        distances[c] = fillSign*radius;
+                }
+                // Where the edges contradict the scanline, such as inside overlapping contours, the edge distances are negated
+                if (channels == 1)
+                    distances[0] = fillSign*fabs(distances[0]);
+                else {
+                    if (fillSign*median(distances[0], distances[1], distances[2]) < 0) {
+                        for (int c = 0; c < 3; ++c)
+                            if (inBand[c])
+                                distances[c] = -distances[c];
+                    }
+                    if (channels > 3)
+                        distances[3] = fillSign*fabs(distances[3]);
+                }
+                storePixel(output(x, row), distances, context.range);
+            }
         }
     }
 
-    if (edgeThreshold > 0)
-        msdfErrorCorrection(output, edgeThreshold/(scale*range));
+private:
+    static const int channels = Selector::channels;
+
+    BitmapRef<T> output;
+    const EdgeBandContext &context;
+
+};
+
+void generateSDF_edgeMajor(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    generateSDF_edgeMajor(output, PreparedShape(shape), range, scale, translate, fillRule);
+}
+
+template <typename T>
+static void generateSDF_edgeMajor(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    EdgeBandContext context(shape, range, scale, translate, fillRule, output.width(), output.height());
+    EdgeMajorJob<TrueDistanceSelector, T> job(output, context);
+    ThreadPool::shared().run(job, context.tiles.size());
+}
+
+void generateSDF_edgeMajor(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    generateSDF_edgeMajor<float>(output, shape, range, scale, translate, fillRule);
+}
+
+void generatePseudoSDF_edgeMajor(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    generatePseudoSDF_edgeMajor(output, PreparedShape(shape), range, scale, translate, fillRule);
+}
+
+template <typename T>
+static void generatePseudoSDF_edgeMajor(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    EdgeBandContext context(shape, range, scale, translate, fillRule, output.width(), output.height());
+    EdgeMajorJob<PseudoDistanceSelector, T> job(output, context);
+    ThreadPool::shared().run(job, context.tiles.size());
+}
+
+void generatePseudoSDF_edgeMajor(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    generatePseudoSDF_edgeMajor<float>(output, shape, range, scale, translate, fillRule);
+}
+
+/// Generates a multi-channel distance field edge by edge and corrects its clashes.
+template <class Selector, typename T>
+static void generateEdgeMajorMultiDistanceField(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    typedef typename Selector::Pixel Pixel;
+    EdgeBandContext context(shape, range, scale, translate, fillRule, output.width(), output.height());
+    if (edgeThreshold <= 0) {
+        EdgeMajorJob<Selector, T> job(output, context);
+        ThreadPool::shared().run(job, context.tiles.size());
+        return;
+    }
+    PooledBitmap<Pixel> buffer;
+    BitmapRef<Pixel> distances = distanceBuffer(output, buffer);
+    EdgeMajorJob<Selector, Pixel> job(distances, context);
+    ThreadPool::shared().run(job, context.tiles.size());
+    msdfErrorCorrection(distances, output, edgeThreshold/(scale*range));
+}
+
+void generateMSDF_edgeMajor(const BitmapRef<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateMSDF_edgeMajor(output, PreparedShape(shape), range, scale, translate, edgeThreshold, fillRule);
+}
+
+template <typename T>
+static void generateMSDF_edgeMajor(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateEdgeMajorMultiDistanceField<MultiDistanceSelector>(output, shape, range, scale, translate, edgeThreshold, fillRule);
+}
+
+void generateMSDF_edgeMajor(const BitmapRef<FloatRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateMSDF_edgeMajor<FloatRGB>(output, shape, range, scale, translate, edgeThreshold, fillRule);
+}
+
+void generateMTSDF_edgeMajor(const BitmapRef<FloatRGBA> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateMTSDF_edgeMajor(output, PreparedShape(shape), range, scale, translate, edgeThreshold, fillRule);
+}
+
+template <typename T>
+static void generateMTSDF_edgeMajor(const BitmapRef<T> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateEdgeMajorMultiDistanceField<MultiAndTrueDistanceSelector>(output, shape, range, scale, translate, edgeThreshold, fillRule);
+}
+
+void generateMTSDF_edgeMajor(const BitmapRef<FloatRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateMTSDF_edgeMajor<FloatRGBA>(output, shape, range, scale, translate, edgeThreshold, fillRule);
+}
+
+// The compact output types of the generators
+void generateSDF(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    generateSDF<unsigned char>(output, shape, range, scale, translate, skipSaturated, fillRule);
+}
+
+void generateSDF(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    generateSDF<Half>(output, shape, range, scale, translate, skipSaturated, fillRule);
+}
+
+void generatePseudoSDF(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    generatePseudoSDF<unsigned char>(output, shape, range, scale, translate, skipSaturated, fillRule);
+}
+
+void generatePseudoSDF(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated, FillRule fillRule) {
+    generatePseudoSDF<Half>(output, shape, range, scale, translate, skipSaturated, fillRule);
+}
+
+void generateMSDF(const BitmapRef<ByteRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMSDF<ByteRGB>(output, shape, range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+void generateMSDF(const BitmapRef<HalfRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMSDF<HalfRGB>(output, shape, range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+void generateMTSDF(const BitmapRef<ByteRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMTSDF<ByteRGBA>(output, shape, range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+void generateMTSDF(const BitmapRef<HalfRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool skipSaturated, FillRule fillRule) {
+    generateMTSDF<HalfRGBA>(output, shape, range, scale, translate, edgeThreshold, skipSaturated, fillRule);
+}
+
+void generateSDF_legacy(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    generateSDF_legacy<unsigned char>(output, shape, range, scale, translate);
+}
+
+void generateSDF_legacy(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    generateSDF_legacy<Half>(output, shape, range, scale, translate);
+}
+
+void generatePseudoSDF_legacy(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    generatePseudoSDF_legacy<unsigned char>(output, shape, range, scale, translate);
+}
+
+void generatePseudoSDF_legacy(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    generatePseudoSDF_legacy<Half>(output, shape, range, scale, translate);
+}
+
+void generateMSDF_legacy(const BitmapRef<ByteRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateMSDF_legacy<ByteRGB>(output, shape, range, scale, translate, edgeThreshold);
+}
+
+void generateMSDF_legacy(const BitmapRef<HalfRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateMSDF_legacy<HalfRGB>(output, shape, range, scale, translate, edgeThreshold);
+}
+
+void generateMTSDF_legacy(const BitmapRef<ByteRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateMTSDF_legacy<ByteRGBA>(output, shape, range, scale, translate, edgeThreshold);
+}
+
+void generateMTSDF_legacy(const BitmapRef<HalfRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold) {
+    generateMTSDF_legacy<HalfRGBA>(output, shape, range, scale, translate, edgeThreshold);
+}
+
+void generateSDF_edgeMajor(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    generateSDF_edgeMajor<unsigned char>(output, shape, range, scale, translate, fillRule);
+}
+
+void generateSDF_edgeMajor(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    generateSDF_edgeMajor<Half>(output, shape, range, scale, translate, fillRule);
+}
+
+void generatePseudoSDF_edgeMajor(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    generatePseudoSDF_edgeMajor<unsigned char>(output, shape, range, scale, translate, fillRule);
+}
+
+void generatePseudoSDF_edgeMajor(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    generatePseudoSDF_edgeMajor<Half>(output, shape, range, scale, translate, fillRule);
+}
+
+void generateMSDF_edgeMajor(const BitmapRef<ByteRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateMSDF_edgeMajor<ByteRGB>(output, shape, range, scale, translate, edgeThreshold, fillRule);
+}
+
+void generateMSDF_edgeMajor(const BitmapRef<HalfRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateMSDF_edgeMajor<HalfRGB>(output, shape, range, scale, translate, edgeThreshold, fillRule);
+}
+
+void generateMTSDF_edgeMajor(const BitmapRef<ByteRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateMTSDF_edgeMajor<ByteRGBA>(output, shape, range, scale, translate, edgeThreshold, fillRule);
+}
+
+void generateMTSDF_edgeMajor(const BitmapRef<HalfRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, FillRule fillRule) {
+    generateMTSDF_edgeMajor<HalfRGBA>(output, shape, range, scale, translate, edgeThreshold, fillRule);
 }
 
 }
@@ -0,0 +1,62 @@
+
+#pragma once
+
+#include <cstring>
+#include "arithmetics.hpp"
+#include "Bitmap.h"
+
+namespace msdfgen {
+
+/// Converts a channel value in the range from 0 to 1 to 8 bits the same way the image writers do.
+inline unsigned char pixelFloatToByte(float x) {
+    return (unsigned char) clamp(int(x*0x100), 0xff);
+}
+
+/// Converts a single-precision value to the nearest half-precision value, ties to even. Values out of range become infinite.
+inline Half floatToHalf(float x) {
+    unsigned bits;
+    memcpy(&bits, &x, sizeof(bits));
+    unsigned sign = bits>>16&0x8000u;
+    int exponent = int(bits>>23&0xffu)-127+15;
+    unsigned mantissa = bits&0x7fffffu;
+    Half half;
+    if ((bits&0x7fffffffu) >= 0x7f800000u)
+        half.bits = (unsigned short) (sign|0x7c00u|(mantissa ? 0x200u : 0u));
+    else if (exponent >= 31)
+        half.bits = (unsigned short) (sign|0x7c00u);
+    else if (exponent <= 0) {
+        // Subnormal half-precision values are multiples of 2^-24
+        if (exponent < -10)
+            half.bits = (unsigned short) sign;
+        else {
+            mantissa |= 0x800000u;
+            int shift = 14-exponent;
+            unsigned h = mantissa>>shift, rest = mantissa&((1u<<shift)-1), halfway = 1u<<(shift-1);
+            if (rest > halfway || (rest == halfway && h&1u))
+                ++h;
+            half.bits = (unsigned short) (sign|h);
+        }
+    } else {
+        // Rounding up may carry into the exponent, which is correct up to infinity
+        unsigned h = (unsigned) exponent<<10|mantissa>>13, rest = mantissa&0x1fffu;
+        if (rest > 0x1000u || (rest == 0x1000u && h&1u))
+            ++h;
+        half.bits = (unsigned short) (sign|h);
+    }
+    return half;
+}
+
+/// Converts a half-precision value to single precision, which is exact.
+inline float halfToFloat(Half x) {
+    unsigned sign = (x.bits&0x8000u)<<16, exponent = x.bits>>10&0x1fu, mantissa = x.bits&0x3ffu;
+    if (!exponent) {
+        float value = float(mantissa)*(1.f/16777216.f);
+        return sign ? -value : value;
+    }
+    unsigned bits = sign|(exponent == 31 ? 0xffu : exponent+112)<<23|mantissa<<13;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}
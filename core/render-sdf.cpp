@@ -2,6 +2,7 @@
 #include "render-sdf.h"
 
 #include "arithmetics.hpp"
+#include "FlatShape.h"
 
 namespace msdfgen {
 
@@ -82,6 +83,59 @@ void renderSDF(Bitmap<FloatRGB> &output, const Bitmap<FloatRGB> &sdf, double pxR
         }
 }
 
+void rasterize(Bitmap<float> &output, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule) {
+    FlatShape flat(shape);
+    int w = output.width(), h = output.height();
+    Scanline scanline;
+    for (int y = 0; y < h; ++y) {
+        int row = flat.inverseYAxis ? h-y-1 : y;
+        flat.scanline(scanline, (y+.5)/scale.y-translate.y);
+        for (int x = 0; x < w; ++x)
+            output(x, row) = scanline.filled((x+.5)/scale.x-translate.x, fillRule) ? 1.f : 0.f;
+    }
+}
+
+/// Returns the length of the outline of the shape in pixels, approximating each edge by a polyline.
+static double outlineLength(const Shape &shape, const Vector2 &scale) {
+    const int steps = 16;
+    double length = 0;
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            Point2 prev = (*edge)->point(0)*scale;
+            for (int i = 1; i <= steps; ++i) {
+                Point2 cur = (*edge)->point((double) i/steps)*scale;
+                length += (cur-prev).length();
+                prev = cur;
+            }
+        }
+    return length;
+}
+
+template <typename T>
+static double reconstructionError(const Bitmap<T> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int width, int height, FillRule fillRule) {
+    // The reference pixels span the same area as the pixels of the distance field
+    Vector2 refScale(scale.x*width/sdf.width(), scale.y*height/sdf.height());
+    double length = outlineLength(shape, refScale);
+    if (!length)
+        return 0;
+    Bitmap<float> reconstruction(width, height), reference(width, height);
+    renderSDF(reconstruction, sdf);
+    rasterize(reference, shape, refScale, translate, fillRule);
+    double area = 0;
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            area += fabs(reconstruction(x, y)-reference(x, y));
+    return area/length;
+}
+
+double measureReconstructionError(const Bitmap<float> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int width, int height, FillRule fillRule) {
+    return reconstructionError(sdf, shape, scale, translate, width, height, fillRule);
+}
+
+double measureReconstructionError(const Bitmap<FloatRGB> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int width, int height, FillRule fillRule) {
+    return reconstructionError(sdf, shape, scale, translate, width, height, fillRule);
+}
+
 void simulate8bit(Bitmap<float> &bitmap) {
     int w = bitmap.width(), h = bitmap.height();
     for (int y = 0; y < h; ++y)
@@ -2,7 +2,9 @@
 #pragma once
 
 #include "Vector2.h"
+#include "Shape.h"
 #include "Bitmap.h"
+#include "Scanline.h"
 
 namespace msdfgen {
 
@@ -12,6 +14,18 @@ void renderSDF(Bitmap<FloatRGB> &output, const Bitmap<float> &sdf, double pxRang
 void renderSDF(Bitmap<float> &output, const Bitmap<FloatRGB> &sdf, double pxRange = 0);
 void renderSDF(Bitmap<FloatRGB> &output, const Bitmap<FloatRGB> &sdf, double pxRange = 0);
 
+/// Rasterizes the shape into output, framed by scale and translate like the distance field generators.
+/// Each pixel is 1 if its center is filled according to the fill rule, or 0 otherwise.
+void rasterize(Bitmap<float> &output, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+
+/** Measures how closely the distance field sdf, generated from the shape framed by scale and translate, reproduces its outline.
+ *  The reconstruction by renderSDF and the rasterized shape are compared at width x height pixels over the area of the distance field.
+ *  Returns the area where they differ divided by the length of the outline, which is the mean distance in these pixels
+ *  between the outlines, or 0 if the shape has no outline.
+ */
+double measureReconstructionError(const Bitmap<float> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int width, int height, FillRule fillRule = FILL_NONZERO);
+double measureReconstructionError(const Bitmap<FloatRGB> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, int width, int height, FillRule fillRule = FILL_NONZERO);
+
 /// Snaps the values of the floating-point bitmaps into one of the 256 values representable in a standard 8-bit bitmap.
 void simulate8bit(Bitmap<float> &bitmap);
 void simulate8bit(Bitmap<FloatRGB> &bitmap);
@@ -2,6 +2,7 @@
 #include "save-bmp.h"
 
 #include <cstdio>
+#include <vector>
 
 #ifdef MSDFGEN_USE_CPP11
     #include <cstdint>
@@ -31,9 +32,11 @@ static bool writeValue(FILE *file, T value) {
     #endif
 }
 
-static bool writeBmpHeader(FILE *file, int width, int height, int &paddedWidth) {
-    paddedWidth = 3*width+3&~3;
-    const uint32_t bitmapStart = 54;
+bool writeBmpHeader(FILE *file, int width, int height, int channels) {
+    // Images with an alpha channel need a version 4 header, since the fourth byte of a pixel is otherwise reserved
+    const uint32_t infoHeaderSize = channels == 4 ? 108 : 40;
+    const uint32_t paddedWidth = (channels*width+3)&~3;
+    const uint32_t bitmapStart = 14+infoHeaderSize;
     const uint32_t bitmapSize = paddedWidth*height;
     const uint32_t fileSize = bitmapStart+bitmapSize;
 
@@ -43,65 +46,134 @@ static bool writeBmpHeader(FILE *file, int width, int height, int &paddedWidth)
     writeValue<uint16_t>(file, 0);
     writeValue<uint32_t>(file, bitmapStart);
 
-    writeValue<uint32_t>(file, 40);
+    writeValue<uint32_t>(file, infoHeaderSize);
     writeValue<int32_t>(file, width);
     writeValue<int32_t>(file, height);
     writeValue<uint16_t>(file, 1);
-    writeValue<uint16_t>(file, 24);
-    writeValue<uint32_t>(file, 0);
+    writeValue<uint16_t>(file, 8*channels);
+    writeValue<uint32_t>(file, channels == 4 ? 3 : 0); // BI_BITFIELDS or BI_RGB
     writeValue<uint32_t>(file, bitmapSize);
     writeValue<uint32_t>(file, 2835);
     writeValue<uint32_t>(file, 2835);
     writeValue<uint32_t>(file, 0);
+    if (channels != 4)
+        return writeValue<uint32_t>(file, 0);
     writeValue<uint32_t>(file, 0);
+    // Red, green, blue and alpha masks of the BGRA pixels
+    writeValue<uint32_t>(file, 0x00ff0000u);
+    writeValue<uint32_t>(file, 0x0000ff00u);
+    writeValue<uint32_t>(file, 0x000000ffu);
+    writeValue<uint32_t>(file, 0xff000000u);
+    // sRGB color space, which ignores the endpoints and gamma that follow
+    writeValue<uint32_t>(file, 0x73524742u);
+    for (int i = 0; i < 11; ++i)
+        writeValue<uint32_t>(file, 0);
+    return writeValue<uint32_t>(file, 0);
+}
 
-    return true;
+static void bmpPixel(uint8_t *dst, float value) {
+    dst[0] = dst[1] = dst[2] = (uint8_t) clamp(int(value*0x100), 0xff);
 }
 
-bool saveBmp(const Bitmap<float> &bitmap, const char *filename) {
-    FILE *file = fopen(filename, "wb");
-    if (!file)
-        return false;
+static void bmpPixel(uint8_t *dst, const FloatRGB &value) {
+    dst[0] = (uint8_t) clamp(int(value.b*0x100), 0xff);
+    dst[1] = (uint8_t) clamp(int(value.g*0x100), 0xff);
+    dst[2] = (uint8_t) clamp(int(value.r*0x100), 0xff);
+}
+
+static void bmpPixel(uint8_t *dst, const FloatRGBA &value) {
+    dst[0] = (uint8_t) clamp(int(value.b*0x100), 0xff);
+    dst[1] = (uint8_t) clamp(int(value.g*0x100), 0xff);
+    dst[2] = (uint8_t) clamp(int(value.r*0x100), 0xff);
+    dst[3] = (uint8_t) clamp(int(value.a*0x100), 0xff);
+}
+
+static void bmpPixel(uint8_t *dst, unsigned char value) {
+    dst[0] = dst[1] = dst[2] = value;
+}
+
+static void bmpPixel(uint8_t *dst, const ByteRGB &value) {
+    dst[0] = value.b;
+    dst[1] = value.g;
+    dst[2] = value.r;
+}
 
-    int paddedWidth;
-    writeBmpHeader(file, bitmap.width(), bitmap.height(), paddedWidth);
+static void bmpPixel(uint8_t *dst, const ByteRGBA &value) {
+    dst[0] = value.b;
+    dst[1] = value.g;
+    dst[2] = value.r;
+    dst[3] = value.a;
+}
 
-    const uint8_t padding[4] = { };
+/// Writes the rows of a Bitmap or BitmapRef, quantized to 8 bits per channel and padded to a multiple of 4 bytes.
+template <int N, class B>
+static bool writeBmpPixelRows(FILE *file, const B &bitmap) {
+    const int paddedWidth = (N*bitmap.width()+3)&~3;
+    std::vector<uint8_t> row(paddedWidth);
     for (int y = 0; y < bitmap.height(); ++y) {
-        for (int x = 0; x < bitmap.width(); ++x) {
-            uint8_t px = (uint8_t) clamp(int(bitmap(x, y)*0x100), 0xff);
-            fwrite(&px, sizeof(uint8_t), 1, file);
-            fwrite(&px, sizeof(uint8_t), 1, file);
-            fwrite(&px, sizeof(uint8_t), 1, file);
-        }
-        fwrite(padding, 1, paddedWidth-3*bitmap.width(), file);
+        for (int x = 0; x < bitmap.width(); ++x)
+            bmpPixel(&row[N*x], bitmap(x, y));
+        if (fwrite(&row[0], 1, paddedWidth, file) != (size_t) paddedWidth)
+            return false;
     }
+    return true;
+}
 
-    return !fclose(file);
+bool writeBmpRows(FILE *file, const BitmapRef<float> &rows) {
+    return writeBmpPixelRows<3>(file, rows);
 }
 
-bool saveBmp(const Bitmap<FloatRGB> &bitmap, const char *filename) {
+bool writeBmpRows(FILE *file, const BitmapRef<FloatRGB> &rows) {
+    return writeBmpPixelRows<3>(file, rows);
+}
+
+bool writeBmpRows(FILE *file, const BitmapRef<FloatRGBA> &rows) {
+    return writeBmpPixelRows<4>(file, rows);
+}
+
+bool writeBmpRows(FILE *file, const BitmapRef<unsigned char> &rows) {
+    return writeBmpPixelRows<3>(file, rows);
+}
+
+bool writeBmpRows(FILE *file, const BitmapRef<ByteRGB> &rows) {
+    return writeBmpPixelRows<3>(file, rows);
+}
+
+bool writeBmpRows(FILE *file, const BitmapRef<ByteRGBA> &rows) {
+    return writeBmpPixelRows<4>(file, rows);
+}
+
+template <int N, typename T>
+static bool saveBmpFile(const Bitmap<T> &bitmap, const char *filename) {
     FILE *file = fopen(filename, "wb");
     if (!file)
         return false;
+    bool success = writeBmpHeader(file, bitmap.width(), bitmap.height(), N) && writeBmpPixelRows<N>(file, bitmap);
+    return !fclose(file) && success;
+}
 
-    int paddedWidth;
-    writeBmpHeader(file, bitmap.width(), bitmap.height(), paddedWidth);
+bool saveBmp(const Bitmap<float> &bitmap, const char *filename) {
+    return saveBmpFile<3>(bitmap, filename);
+}
 
-    const uint8_t padding[4] = { };
-    for (int y = 0; y < bitmap.height(); ++y) {
-        for (int x = 0; x < bitmap.width(); ++x) {
-            uint8_t bgr[3] = {
-                (uint8_t) clamp(int(bitmap(x, y).b*0x100), 0xff),
-                (uint8_t) clamp(int(bitmap(x, y).g*0x100), 0xff),
-                (uint8_t) clamp(int(bitmap(x, y).r*0x100), 0xff)
-            };
-            fwrite(bgr, sizeof(uint8_t), 3, file);
-        }
-        fwrite(padding, 1, paddedWidth-3*bitmap.width(), file);
-    }
+bool saveBmp(const Bitmap<FloatRGB> &bitmap, const char *filename) {
+    return saveBmpFile<3>(bitmap, filename);
+}
+
+bool saveBmp(const Bitmap<FloatRGBA> &bitmap, const char *filename) {
+    return saveBmpFile<4>(bitmap, filename);
+}
+
+bool saveBmp(const Bitmap<unsigned char> &bitmap, const char *filename) {
+    return saveBmpFile<3>(bitmap, filename);
+}
+
+bool saveBmp(const Bitmap<ByteRGB> &bitmap, const char *filename) {
+    return saveBmpFile<3>(bitmap, filename);
+}
 
-    return !fclose(file);
+bool saveBmp(const Bitmap<ByteRGBA> &bitmap, const char *filename) {
+    return saveBmpFile<4>(bitmap, filename);
 }
 
 }
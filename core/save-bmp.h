@@ -1,12 +1,29 @@
 
 #pragma once
 
+#include <cstdio>
 #include "Bitmap.h"
+#include "BitmapRef.h"
 
 namespace msdfgen {
 
 /// Saves the bitmap as a BMP file.
 bool saveBmp(const Bitmap<float> &bitmap, const char *filename);
 bool saveBmp(const Bitmap<FloatRGB> &bitmap, const char *filename);
+bool saveBmp(const Bitmap<FloatRGBA> &bitmap, const char *filename);
+bool saveBmp(const Bitmap<unsigned char> &bitmap, const char *filename);
+bool saveBmp(const Bitmap<ByteRGB> &bitmap, const char *filename);
+bool saveBmp(const Bitmap<ByteRGBA> &bitmap, const char *filename);
+
+/// Writes the header of a BMP image with 3 or 4 channels, the fourth being alpha, whose rows must then be written from the bottom up using writeBmpRows.
+/// This allows an image to be saved in parts, without having all of it in memory at once.
+bool writeBmpHeader(FILE *file, int width, int height, int channels);
+/// Appends the rows of the bitmap region to a BMP image started by writeBmpHeader. Single-channel pixels are written as 3 channels.
+bool writeBmpRows(FILE *file, const BitmapRef<float> &rows);
+bool writeBmpRows(FILE *file, const BitmapRef<FloatRGB> &rows);
+bool writeBmpRows(FILE *file, const BitmapRef<FloatRGBA> &rows);
+bool writeBmpRows(FILE *file, const BitmapRef<unsigned char> &rows);
+bool writeBmpRows(FILE *file, const BitmapRef<ByteRGB> &rows);
+bool writeBmpRows(FILE *file, const BitmapRef<ByteRGBA> &rows);
 
 }
@@ -0,0 +1,367 @@
+
+#include "DynamicAtlas.h"
+
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#ifdef MSDFGEN_USE_CPP11
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+#endif
+#include "../msdfgen.h"
+
+#define LARGE_VALUE 1e240
+
+namespace msdfgen {
+
+/// Extends a to also cover b if they share a whole side.
+static bool mergeRects(AtlasRect &a, const AtlasRect &b) {
+    if (a.y == b.y && a.height == b.height && (a.x+a.width == b.x || b.x+b.width == a.x)) {
+        a.x = std::min(a.x, b.x);
+        a.width += b.width;
+        return true;
+    }
+    if (a.x == b.x && a.width == b.width && (a.y+a.height == b.y || b.y+b.height == a.y)) {
+        a.y = std::min(a.y, b.y);
+        a.height += b.height;
+        return true;
+    }
+    return false;
+}
+
+struct DynamicAtlas::Worker {
+#ifdef MSDFGEN_USE_CPP11
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool quit;
+
+    Worker() : quit(false) { }
+
+    void work(DynamicAtlas *atlas) {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!quit && atlas->queue.empty())
+                    wake.wait(lock);
+                if (quit)
+                    return;
+            }
+            atlas->generateNext();
+        }
+    }
+#endif
+};
+
+DynamicAtlas::DynamicAtlas(FontHandle *font, int width, int height, double emSize, double pxRange, double angleThreshold, double edgeThreshold) :
+    font(font), glyphScale(1), range(1), angleThreshold(angleThreshold), edgeThreshold(edgeThreshold), atlas(width, height), frame(0), worker(new Worker) {
+    double fontScale;
+    if (getFontScale(fontScale, font) && fontScale > 0)
+        glyphScale = emSize/fontScale;
+    range = pxRange/glyphScale;
+    Skyline ground = { 0, 0, width };
+    skyline.push_back(ground);
+#ifdef MSDFGEN_USE_CPP11
+    worker->thread = std::thread(&Worker::work, worker, this);
+#endif
+}
+
+DynamicAtlas::~DynamicAtlas() {
+#ifdef MSDFGEN_USE_CPP11
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->quit = true;
+    }
+    worker->wake.notify_all();
+    worker->thread.join();
+#endif
+    delete worker;
+}
+
+int DynamicAtlas::width() const {
+    return atlas.width();
+}
+
+int DynamicAtlas::height() const {
+    return atlas.height();
+}
+
+double DynamicAtlas::scale() const {
+    return glyphScale;
+}
+
+bool DynamicAtlas::findGlyph(int unicode, AtlasGlyph &glyph) {
+    {
+#ifdef MSDFGEN_USE_CPP11
+        std::lock_guard<std::mutex> lock(worker->mutex);
+#endif
+        Entry &entry = entries[unicode];
+        if (entry.state == READY) {
+            entry.lastFrame = frame;
+            if (entry.glyph.rect.width)
+                uses.splice(uses.begin(), uses, entry.use);
+            glyph = entry.glyph;
+            return true;
+        }
+        // A glyph that did not fit is retried once per frame, after the glyphs used before it in the frame are marked
+        bool retry = entry.state == DEFERRED && entry.lastFrame != frame;
+        entry.lastFrame = frame;
+        if (entry.state != NEW && !retry)
+            return false;
+        entry.state = QUEUED;
+        queue.push_back(unicode);
+    }
+#ifdef MSDFGEN_USE_CPP11
+    worker->wake.notify_one();
+    return false;
+#else
+    generateNext();
+    Entry &entry = entries[unicode];
+    if (entry.state != READY)
+        return false;
+    if (entry.glyph.rect.width)
+        uses.splice(uses.begin(), uses, entry.use);
+    glyph = entry.glyph;
+    return true;
+#endif
+}
+
+void DynamicAtlas::nextFrame() {
+#ifdef MSDFGEN_USE_CPP11
+    std::lock_guard<std::mutex> lock(worker->mutex);
+#endif
+    ++frame;
+}
+
+bool DynamicAtlas::takeDirtyRect(AtlasRect &rect, Bitmap<ByteRGB> &pixels) {
+#ifdef MSDFGEN_USE_CPP11
+    std::lock_guard<std::mutex> lock(worker->mutex);
+#endif
+    if (dirtyRects.empty())
+        return false;
+    rect = dirtyRects.back();
+    dirtyRects.pop_back();
+    pixels.resize(rect.width, rect.height);
+    for (int y = 0; y < rect.height; ++y) {
+        const ByteRGB *src = atlas.row(rect.y+y)+rect.x;
+        std::copy(src, src+rect.width, pixels.row(y));
+    }
+    return true;
+}
+
+/// Generates the next queued glyph. Returns false if the queue is empty.
+bool DynamicAtlas::generateNext() {
+    int unicode;
+    {
+#ifdef MSDFGEN_USE_CPP11
+        std::lock_guard<std::mutex> lock(worker->mutex);
+#endif
+        if (queue.empty())
+            return false;
+        unicode = queue.front();
+        queue.pop_front();
+        entries[unicode].state = GENERATING;
+    }
+
+    // The shape is loaded and prepared without holding the lock, since only this thread uses the font
+    Shape shape;
+    AtlasGlyph glyph = { };
+    double advance = 0;
+    bool loaded = loadGlyph(shape, font, unicode, &advance) && shape.validate();
+    if (loaded) {
+        shape.normalize();
+        edgeColoringSimple(shape, angleThreshold);
+        double l = LARGE_VALUE, b = LARGE_VALUE, r = -LARGE_VALUE, t = -LARGE_VALUE;
+        shape.bounds(l, b, r, t);
+        if (l < r && b < t) {
+            int x0 = (int) floor((l-range)*glyphScale), y0 = (int) floor((b-range)*glyphScale);
+            int x1 = (int) ceil((r+range)*glyphScale), y1 = (int) ceil((t+range)*glyphScale);
+            glyph.rect.width = x1-x0;
+            glyph.rect.height = y1-y0;
+            glyph.translate = Vector2(-x0/glyphScale, -y0/glyphScale);
+        }
+        glyph.advance = advance;
+    }
+
+    {
+#ifdef MSDFGEN_USE_CPP11
+        std::lock_guard<std::mutex> lock(worker->mutex);
+#endif
+        Entry &entry = entries[unicode];
+        if (!loaded || glyph.rect.width > atlas.width() || glyph.rect.height > atlas.height()) {
+            entry.state = FAILED;
+            return true;
+        }
+        if (glyph.rect.width && !allocate(glyph.rect)) {
+            entry.state = DEFERRED;
+            return true;
+        }
+        entry.glyph = glyph;
+    }
+
+    // The cell belongs to this glyph alone, so it is filled without holding the lock
+    if (glyph.rect.width) {
+        BitmapRef<ByteRGB> cell = BitmapRef<ByteRGB>(atlas).region(glyph.rect.x, glyph.rect.y, glyph.rect.width, glyph.rect.height);
+        generateMSDF(cell, PreparedShape(shape), range, Vector2(glyphScale), glyph.translate, edgeThreshold);
+    }
+
+    {
+#ifdef MSDFGEN_USE_CPP11
+        std::lock_guard<std::mutex> lock(worker->mutex);
+#endif
+        // A glyph counts as used in the frame it is completed in, so that it is not evicted before it is first retrieved
+        Entry &entry = entries[unicode];
+        entry.state = READY;
+        entry.lastFrame = frame;
+        if (glyph.rect.width) {
+            uses.push_front(unicode);
+            entry.use = uses.begin();
+            dirtyRects.push_back(glyph.rect);
+        }
+    }
+    return true;
+}
+
+/// Finds a cell for rect, evicting glyphs while there is no space left.
+bool DynamicAtlas::allocate(AtlasRect &rect) {
+    for (;;) {
+        if (allocateFree(rect) || allocateSkyline(rect))
+            return true;
+        lowerSkyline();
+        if (allocateSkyline(rect))
+            return true;
+        if (!evict())
+            return false;
+    }
+}
+
+/// Places rect in the smallest cell of an evicted glyph that it fits in, and returns the rest of the cell to the free list.
+bool DynamicAtlas::allocateFree(AtlasRect &rect) {
+    int best = -1;
+    double bestArea = 0;
+    for (int i = 0; i < (int) freeRects.size(); ++i) {
+        const AtlasRect &cell = freeRects[i];
+        double area = (double) cell.width*cell.height;
+        if (cell.width >= rect.width && cell.height >= rect.height && (best < 0 || area < bestArea)) {
+            best = i;
+            bestArea = area;
+        }
+    }
+    if (best < 0)
+        return false;
+    AtlasRect cell = freeRects[best];
+    freeRects.erase(freeRects.begin()+best);
+    rect.x = cell.x;
+    rect.y = cell.y;
+    // Split along the shorter leftover side so that the larger remainder stays in one piece
+    AtlasRect right = { cell.x+rect.width, cell.y, cell.width-rect.width, rect.height };
+    AtlasRect top = { cell.x, cell.y+rect.height, cell.width, cell.height-rect.height };
+    if (cell.width-rect.width > cell.height-rect.height) {
+        right.height = cell.height;
+        top.width = rect.width;
+    }
+    if (right.width > 0 && right.height > 0)
+        freeRects.push_back(right);
+    if (top.width > 0 && top.height > 0)
+        freeRects.push_back(top);
+    return true;
+}
+
+/// Places rect at the lowest position of the skyline where it fits, leftmost among equals.
+bool DynamicAtlas::allocateSkyline(AtlasRect &rect) {
+    int best = -1, bestY = INT_MAX;
+    for (int i = 0; i < (int) skyline.size() && skyline[i].x+rect.width <= atlas.width(); ++i) {
+        int y = 0;
+        for (int j = i, remaining = rect.width; remaining > 0; remaining -= skyline[j++].width)
+            y = std::max(y, skyline[j].y);
+        if (y+rect.height <= atlas.height() && y < bestY) {
+            best = i;
+            bestY = y;
+        }
+    }
+    if (best < 0)
+        return false;
+    rect.x = skyline[best].x;
+    rect.y = bestY;
+    Skyline top = { rect.x, bestY+rect.height, rect.width };
+    skyline.insert(skyline.begin()+best, top);
+    // Trim the nodes covered by the new one
+    int end = rect.x+rect.width;
+    for (int i = best+1; i < (int) skyline.size() && skyline[i].x < end;) {
+        int overlap = end-skyline[i].x;
+        if (overlap >= skyline[i].width)
+            skyline.erase(skyline.begin()+i);
+        else {
+            skyline[i].x += overlap;
+            skyline[i].width -= overlap;
+            break;
+        }
+    }
+    for (int i = 0; i+1 < (int) skyline.size();) {
+        if (skyline[i].y == skyline[i+1].y) {
+            skyline[i].width += skyline[i+1].width;
+            skyline.erase(skyline.begin()+i+1);
+        } else
+            ++i;
+    }
+    return true;
+}
+
+/// Evicts the least recently used glyph unless it has been used in the current frame.
+bool DynamicAtlas::evict() {
+    if (uses.empty())
+        return false;
+    std::map<int, Entry>::iterator it = entries.find(uses.back());
+    if (it->second.lastFrame == frame)
+        return false;
+    AtlasRect rect = it->second.glyph.rect;
+    uses.pop_back();
+    entries.erase(it);
+    for (std::vector<AtlasRect>::iterator dirty = dirtyRects.begin(); dirty != dirtyRects.end(); ++dirty)
+        if (dirty->x == rect.x && dirty->y == rect.y) {
+            dirtyRects.erase(dirty);
+            break;
+        }
+    for (int i = 0; i < (int) freeRects.size();) {
+        if (mergeRects(rect, freeRects[i])) {
+            freeRects.erase(freeRects.begin()+i);
+            i = 0;
+        } else
+            ++i;
+    }
+    freeRects.push_back(rect);
+    return true;
+}
+
+/// Lowers the skyline onto the cells of the glyphs in the atlas, which reclaims the space of evicted glyphs at its top.
+/// The cells of evicted glyphs that rise above the new skyline become part of the space above it.
+void DynamicAtlas::lowerSkyline() {
+    std::vector<int> heights(atlas.width(), 0);
+    for (std::map<int, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        const AtlasRect &cell = it->second.glyph.rect;
+        if (it->second.state == READY)
+            for (int x = cell.x; x < cell.x+cell.width; ++x)
+                heights[x] = std::max(heights[x], cell.y+cell.height);
+    }
+    for (int i = 0; i < (int) freeRects.size();) {
+        const AtlasRect &cell = freeRects[i];
+        bool covered = true;
+        for (int x = cell.x; x < cell.x+cell.width && covered; ++x)
+            covered = heights[x] >= cell.y+cell.height;
+        if (covered)
+            ++i;
+        else
+            freeRects.erase(freeRects.begin()+i);
+    }
+    skyline.clear();
+    for (int x = 0; x < atlas.width(); ++x) {
+        if (skyline.empty() || skyline.back().y != heights[x]) {
+            Skyline node = { x, heights[x], 0 };
+            skyline.push_back(node);
+        }
+        ++skyline.back().width;
+    }
+}
+
+}
@@ -0,0 +1,110 @@
+
+#pragma once
+
+#include <map>
+#include <list>
+#include <deque>
+#include <vector>
+#include "../core/Vector2.h"
+#include "../core/Bitmap.h"
+#include "import-font.h"
+
+namespace msdfgen {
+
+/// A rectangle of pixels in an atlas.
+struct AtlasRect {
+    int x, y, width, height;
+};
+
+/// The placement of a glyph in a dynamic atlas.
+struct AtlasGlyph {
+    /// The cell of the glyph in the atlas. Empty for glyphs without an outline, such as the space.
+    AtlasRect rect;
+    /// The point of the glyph's shape at the lower left corner of its cell is -translate. See DynamicAtlas::scale.
+    Vector2 translate;
+    /// The horizontal advance of the glyph in shape units.
+    double advance;
+};
+
+/** A fixed-size atlas of multi-channel signed distance fields of the glyphs of a font, which are generated on demand.
+ *  A glyph that is not in the atlas yet is queued by findGlyph and generated by a background thread, so that the caller
+ *  never waits for it. Its cell is allocated from the space of evicted glyphs or by a skyline allocator, and once the atlas
+ *  is full, the least recently used glyphs are evicted, except those used since the last call to nextFrame.
+ *  The pixels of newly generated glyphs are retrieved with takeDirtyRect for partial texture upload.
+ *  Like in the output of the generators, the lowest row of the atlas is the bottom of the glyphs.
+ *  Without MSDFGEN_USE_CPP11, findGlyph generates the glyph before it returns.
+ */
+class DynamicAtlas {
+
+public:
+    /** Creates an atlas of width x height pixels for the glyphs of the font, which must outlive it
+     *  and must not be used by other threads while glyphs are generated. The glyphs are scaled to emSize pixels per EM
+     *  and their distance fields span pxRange pixels. See generateMSDF and edgeColoringSimple for the other parameters.
+     */
+    DynamicAtlas(FontHandle *font, int width, int height, double emSize, double pxRange, double angleThreshold = 3, double edgeThreshold = 1.00000001);
+    ~DynamicAtlas();
+    /// Width of the atlas in pixels.
+    int width() const;
+    /// Height of the atlas in pixels.
+    int height() const;
+    /// Number of pixels per shape unit of the glyphs.
+    double scale() const;
+    /// Retrieves the glyph and marks it as used. Returns false if it is not in the atlas yet, in which case it is queued,
+    /// or if it cannot be loaded from the font.
+    bool findGlyph(int unicode, AtlasGlyph &glyph);
+    /// Starts a new frame. The glyphs used in the previous frame may be evicted from now on,
+    /// and glyphs that did not fit because no glyph could be evicted are queued again when they are next requested.
+    void nextFrame();
+    /// Retrieves a rectangle of the atlas that has changed since it was last retrieved, and its pixels.
+    /// Returns false if there is none.
+    bool takeDirtyRect(AtlasRect &rect, Bitmap<ByteRGB> &pixels);
+
+private:
+    enum State {
+        NEW,
+        QUEUED,
+        GENERATING,
+        READY,
+        DEFERRED,
+        FAILED
+    };
+    struct Entry {
+        State state;
+        AtlasGlyph glyph;
+        std::list<int>::iterator use;
+        unsigned lastFrame;
+        Entry() : state(NEW), lastFrame(0) { }
+    };
+    struct Skyline {
+        int x, y, width;
+    };
+    struct Worker;
+
+    FontHandle *font;
+    double glyphScale, range;
+    double angleThreshold, edgeThreshold;
+    Bitmap<ByteRGB> atlas;
+    std::map<int, Entry> entries;
+    /// Glyphs in the atlas from the most to the least recently used.
+    std::list<int> uses;
+    std::deque<int> queue;
+    std::vector<Skyline> skyline;
+    /// Cells of evicted glyphs.
+    std::vector<AtlasRect> freeRects;
+    std::vector<AtlasRect> dirtyRects;
+    unsigned frame;
+    Worker *worker;
+
+    bool generateNext();
+    bool allocate(AtlasRect &rect);
+    bool allocateFree(AtlasRect &rect);
+    bool allocateSkyline(AtlasRect &rect);
+    bool evict();
+    void lowerSkyline();
+
+    DynamicAtlas(const DynamicAtlas &);
+    DynamicAtlas & operator=(const DynamicAtlas &);
+
+};
+
+}
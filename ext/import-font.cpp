@@ -55,21 +55,21 @@ static int ftMoveTo(const FT_Vector *to, void *user) {
 
 static int ftLineTo(const FT_Vector *to, void *user) {
     FtContext *context = reinterpret_cast<FtContext *>(user);
-    context->contour->addEdge(new LinearSegment(context->position, ftPoint2(*to)));
+    context->contour->addEdge(EdgeHolder(context->position, ftPoint2(*to)));
     context->position = ftPoint2(*to);
     return 0;
 }
 
 static int ftConicTo(const FT_Vector *control, const FT_Vector *to, void *user) {
     FtContext *context = reinterpret_cast<FtContext *>(user);
-    context->contour->addEdge(new QuadraticSegment(context->position, ftPoint2(*control), ftPoint2(*to)));
+    context->contour->addEdge(EdgeHolder(context->position, ftPoint2(*control), ftPoint2(*to)));
     context->position = ftPoint2(*to);
     return 0;
 }
 
 static int ftCubicTo(const FT_Vector *control1, const FT_Vector *control2, const FT_Vector *to, void *user) {
     FtContext *context = reinterpret_cast<FtContext *>(user);
-    context->contour->addEdge(new CubicSegment(context->position, ftPoint2(*control1), ftPoint2(*control2), ftPoint2(*to)));
+    context->contour->addEdge(EdgeHolder(context->position, ftPoint2(*control1), ftPoint2(*control2), ftPoint2(*to)));
     context->position = ftPoint2(*to);
     return 0;
 }
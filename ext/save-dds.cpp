@@ -1,6 +1,7 @@
 #include "save-dds.h"
 #include <dxgi1_3.h> //for DXGI_FORMAT
 #include <stdio.h>
+#include <string.h>
 
 struct DDS_PIXELFORMAT {
 	DWORD dwSize;
@@ -42,16 +43,17 @@ enum DDS_FLAGS {
 	DDSCAPS_TEXTURE = 0x1000
 };
 namespace msdfgen {
-	bool saveDDS(const Bitmap<FloatRGB> &bitmap, const char *filename) {
+	/// Writes a 32-bit uncompressed DDS file of pixels given in the byte order of the bitmap's channels.
+	static bool writeDDS(const unsigned char *pixelBuffer, int width, int height, const char *filename) {
 		DDSHeader header;
 		memset(&header, 0x0, sizeof(DDSHeader));
 		header.dwSize = sizeof(DDSHeader);
-		header.dwWidth = bitmap.width();
-		header.dwHeight = bitmap.height();
+		header.dwWidth = width;
+		header.dwHeight = height;
 		header.dwMipMapCount = 1;
 		header.dwDepth = 0;
 		header.dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT;
-		header.dwPitchOrLinearSize = (bitmap.width() * 32 + 7) / 8;
+		header.dwPitchOrLinearSize = (width * 32 + 7) / 8;
 		header.dwCaps = DDSCAPS_TEXTURE;
 		header.ddspf.dwSize = sizeof(DDS_PIXELFORMAT);
 		//header.ddspf.dwFourCC = 0x44583130; //"DX10"
@@ -62,15 +64,6 @@ namespace msdfgen {
 		header.ddspf.dwGBitMask = 0x0000ff00;
 		header.ddspf.dwBBitMask = 0x000000ff;
 
-		unsigned char* pixelBuffer = (unsigned char*)malloc(4 * header.dwWidth * header.dwHeight);
-		for (int y = header.dwHeight - 1; y >= 0; --y) {
-			for (int x = 0; x < header.dwWidth; x++) {
-				pixelBuffer[(y * header.dwWidth + x) * 4] = clamp(int(bitmap(x, y).r * 0x100), 0xff);
-				pixelBuffer[(y * header.dwWidth + x) * 4 + 1] = clamp(int(bitmap(x, y).g * 0x100), 0xff);
-				pixelBuffer[(y * header.dwWidth + x) * 4 + 2] = clamp(int(bitmap(x, y).b * 0x100), 0xff);
-				pixelBuffer[(y * header.dwWidth + x) * 4 + 3] = 0xff;
-			}
-		}
 		FILE* f = fopen(filename, "wb");
 		if (!f)
 			return false;
@@ -79,7 +72,101 @@ namespace msdfgen {
 		fwrite(&header, sizeof(DDSHeader), 1, f);
 		fwrite(pixelBuffer, header.dwPitchOrLinearSize, header.dwHeight, f);
 		fclose(f);
-		free(pixelBuffer);
 		return true;
 	}
+
+	bool saveDDS(const Bitmap<float> &bitmap, const char *filename) {
+		int width = bitmap.width(), height = bitmap.height();
+		unsigned char* pixelBuffer = (unsigned char*)malloc(4 * width * height);
+		for (int y = height - 1; y >= 0; --y) {
+			for (int x = 0; x < width; x++) {
+				unsigned char v = clamp(int(bitmap(x, y) * 0x100), 0xff);
+				pixelBuffer[(y * width + x) * 4] = v;
+				pixelBuffer[(y * width + x) * 4 + 1] = v;
+				pixelBuffer[(y * width + x) * 4 + 2] = v;
+				pixelBuffer[(y * width + x) * 4 + 3] = 0xff;
+			}
+		}
+		bool result = writeDDS(pixelBuffer, width, height, filename);
+		free(pixelBuffer);
+		return result;
+	}
+
+	bool saveDDS(const Bitmap<FloatRGB> &bitmap, const char *filename) {
+		int width = bitmap.width(), height = bitmap.height();
+		unsigned char* pixelBuffer = (unsigned char*)malloc(4 * width * height);
+		for (int y = height - 1; y >= 0; --y) {
+			for (int x = 0; x < width; x++) {
+				pixelBuffer[(y * width + x) * 4] = clamp(int(bitmap(x, y).r * 0x100), 0xff);
+				pixelBuffer[(y * width + x) * 4 + 1] = clamp(int(bitmap(x, y).g * 0x100), 0xff);
+				pixelBuffer[(y * width + x) * 4 + 2] = clamp(int(bitmap(x, y).b * 0x100), 0xff);
+				pixelBuffer[(y * width + x) * 4 + 3] = 0xff;
+			}
+		}
+		bool result = writeDDS(pixelBuffer, width, height, filename);
+		free(pixelBuffer);
+		return result;
+	}
+
+	bool saveDDS(const Bitmap<FloatRGBA> &bitmap, const char *filename) {
+		int width = bitmap.width(), height = bitmap.height();
+		unsigned char* pixelBuffer = (unsigned char*)malloc(4 * width * height);
+		for (int y = height - 1; y >= 0; --y) {
+			for (int x = 0; x < width; x++) {
+				pixelBuffer[(y * width + x) * 4] = clamp(int(bitmap(x, y).r * 0x100), 0xff);
+				pixelBuffer[(y * width + x) * 4 + 1] = clamp(int(bitmap(x, y).g * 0x100), 0xff);
+				pixelBuffer[(y * width + x) * 4 + 2] = clamp(int(bitmap(x, y).b * 0x100), 0xff);
+				pixelBuffer[(y * width + x) * 4 + 3] = clamp(int(bitmap(x, y).a * 0x100), 0xff);
+			}
+		}
+		bool result = writeDDS(pixelBuffer, width, height, filename);
+		free(pixelBuffer);
+		return result;
+	}
+
+	bool saveDDS(const Bitmap<unsigned char> &bitmap, const char *filename) {
+		int width = bitmap.width(), height = bitmap.height();
+		unsigned char* pixelBuffer = (unsigned char*)malloc(4 * width * height);
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; x++) {
+				unsigned char v = bitmap(x, y);
+				pixelBuffer[(y * width + x) * 4] = v;
+				pixelBuffer[(y * width + x) * 4 + 1] = v;
+				pixelBuffer[(y * width + x) * 4 + 2] = v;
+				pixelBuffer[(y * width + x) * 4 + 3] = 0xff;
+			}
+		}
+		bool result = writeDDS(pixelBuffer, width, height, filename);
+		free(pixelBuffer);
+		return result;
+	}
+
+	bool saveDDS(const Bitmap<ByteRGB> &bitmap, const char *filename) {
+		int width = bitmap.width(), height = bitmap.height();
+		unsigned char* pixelBuffer = (unsigned char*)malloc(4 * width * height);
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; x++) {
+				pixelBuffer[(y * width + x) * 4] = bitmap(x, y).r;
+				pixelBuffer[(y * width + x) * 4 + 1] = bitmap(x, y).g;
+				pixelBuffer[(y * width + x) * 4 + 2] = bitmap(x, y).b;
+				pixelBuffer[(y * width + x) * 4 + 3] = 0xff;
+			}
+		}
+		bool result = writeDDS(pixelBuffer, width, height, filename);
+		free(pixelBuffer);
+		return result;
+	}
+
+	bool saveDDS(const Bitmap<ByteRGBA> &bitmap, const char *filename) {
+		int width = bitmap.width(), height = bitmap.height();
+		if (bitmap.stride() == width)
+			return writeDDS(reinterpret_cast<const unsigned char *>(bitmap.row(0)), width, height, filename);
+		// Padded rows are packed first
+		unsigned char* pixelBuffer = (unsigned char*)malloc(4 * width * height);
+		for (int y = 0; y < height; ++y)
+			memcpy(pixelBuffer + y * width * 4, bitmap.row(y), 4 * width);
+		bool result = writeDDS(pixelBuffer, width, height, filename);
+		free(pixelBuffer);
+		return result;
+	}
 }
@@ -5,7 +5,12 @@
 namespace msdfgen {
 
 	/// Saves the bitmap as a PNG file.
-	//bool saveDDS(const Bitmap<float> &bitmap, const char *filename);
+	bool saveDDS(const Bitmap<float> &bitmap, const char *filename);
 	bool saveDDS(const Bitmap<FloatRGB> &bitmap, const char *filename);
+	bool saveDDS(const Bitmap<FloatRGBA> &bitmap, const char *filename);
+	bool saveDDS(const Bitmap<unsigned char> &bitmap, const char *filename);
+	bool saveDDS(const Bitmap<ByteRGB> &bitmap, const char *filename);
+	/// The pixels of an RGBA bitmap are already in the layout of the file and are written without conversion.
+	bool saveDDS(const Bitmap<ByteRGBA> &bitmap, const char *filename);
 
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "save-png.h"
 
 #include "../core/arithmetics.hpp"
+#include <algorithm>
 #include <lodepng.h>
 
 namespace msdfgen {
@@ -27,4 +28,41 @@ bool savePng(const Bitmap<FloatRGB> &bitmap, const char *filename) {
     return !lodepng::encode(filename, pixels, bitmap.width(), bitmap.height(), LCT_RGB);
 }
 
+bool savePng(const Bitmap<FloatRGBA> &bitmap, const char *filename) {
+    std::vector<unsigned char> pixels(4*bitmap.width()*bitmap.height());
+    std::vector<unsigned char>::iterator it = pixels.begin();
+    for (int y = bitmap.height()-1; y >= 0; --y)
+        for (int x = 0; x < bitmap.width(); ++x) {
+            *it++ = clamp(int(bitmap(x, y).r*0x100), 0xff);
+            *it++ = clamp(int(bitmap(x, y).g*0x100), 0xff);
+            *it++ = clamp(int(bitmap(x, y).b*0x100), 0xff);
+            *it++ = clamp(int(bitmap(x, y).a*0x100), 0xff);
+        }
+    return !lodepng::encode(filename, pixels, bitmap.width(), bitmap.height(), LCT_RGBA);
+}
+
+/// Encodes the rows of an 8-bit bitmap, which are stored from the bottom up, as a PNG file.
+template <typename T>
+static bool savePngRows(const Bitmap<T> &bitmap, const char *filename, LodePNGColorType colorType) {
+    std::vector<unsigned char> pixels(sizeof(T)*bitmap.width()*bitmap.height());
+    std::vector<unsigned char>::iterator it = pixels.begin();
+    for (int y = bitmap.height()-1; y >= 0; --y) {
+        const unsigned char *row = reinterpret_cast<const unsigned char *>(&bitmap(0, y));
+        it = std::copy(row, row+sizeof(T)*bitmap.width(), it);
+    }
+    return !lodepng::encode(filename, pixels, bitmap.width(), bitmap.height(), colorType);
+}
+
+bool savePng(const Bitmap<unsigned char> &bitmap, const char *filename) {
+    return savePngRows(bitmap, filename, LCT_GREY);
+}
+
+bool savePng(const Bitmap<ByteRGB> &bitmap, const char *filename) {
+    return savePngRows(bitmap, filename, LCT_RGB);
+}
+
+bool savePng(const Bitmap<ByteRGBA> &bitmap, const char *filename) {
+    return savePngRows(bitmap, filename, LCT_RGBA);
+}
+
 }
@@ -8,5 +8,10 @@ namespace msdfgen {
 /// Saves the bitmap as a PNG file.
 bool savePng(const Bitmap<float> &bitmap, const char *filename);
 bool savePng(const Bitmap<FloatRGB> &bitmap, const char *filename);
+bool savePng(const Bitmap<FloatRGBA> &bitmap, const char *filename);
+/// Saves an 8-bit bitmap as a PNG file without converting its pixels.
+bool savePng(const Bitmap<unsigned char> &bitmap, const char *filename);
+bool savePng(const Bitmap<ByteRGB> &bitmap, const char *filename);
+bool savePng(const Bitmap<ByteRGBA> &bitmap, const char *filename);
 
 }
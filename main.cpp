@@ -13,6 +13,10 @@
 #include <cmath>
 #include <cstring>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <fstream>
 #include <sstream>
 #define STB_RECT_PACK_IMPLEMENTATION
@@ -23,6 +27,10 @@
 
 #ifdef _WIN32
     #pragma warning(disable:4996)
+    #include <process.h>
+    #define getpid _getpid
+#else
+    #include <unistd.h>
 #endif
 
 #define LARGE_VALUE 1e240
@@ -41,6 +49,14 @@ enum Format {
 	DDS
 };
 
+enum Mode {
+    SINGLE,
+    PSEUDO,
+    MULTI,
+    MULTI_AND_TRUE,
+    METRICS
+};
+
 struct Glyph {
 	int code; //unicode code
 	Shape shape; //vector shape of the glyph
@@ -51,11 +67,43 @@ struct Glyph {
 	float yoffset;
 	int width;
 	int height;
-	Bitmap<FloatRGB> bitmap; //generated bitmap msdf
+	Vector2 scale; //framing of the shape in the bitmap
+	Vector2 translate;
+	double range;
+	int page; //index of the atlas page
+	int size; //width of the frame the glyph is generated in, smaller than -size if chosen by -adaptivesize
 
 	
 };
 
+/// The dimensions of a page of the atlas.
+struct AtlasPage {
+	int width;
+	int height;
+};
+
+/// Adapts a function to a thread pool job.
+class FunctionJob : public ThreadPool::Job {
+
+public:
+	explicit FunctionJob(const std::function<void(int)> &function) : function(function) { }
+	void execute(int task) {
+		function(task);
+	}
+
+private:
+	std::function<void(int)> function;
+
+};
+
+/// Estimates the relative time it takes to generate the distance field of a glyph.
+static double estimateGlyphCost(const Glyph &glyph) {
+	size_t edgeCount = 0;
+	for (std::vector<Contour>::const_iterator contour = glyph.shape.contours.begin(); contour != glyph.shape.contours.end(); ++contour)
+		edgeCount += contour->edges.size();
+	return (double) edgeCount*glyph.width*glyph.height;
+}
+
 static char toupper(char c) {
     return c >= 'a' && c <= 'z' ? c-'a'+'A' : c;
 }
@@ -170,21 +218,81 @@ static void parseColoring(Shape &shape, const char *edgeAssignment) {
     }
 }
 
-static void invertColor(Bitmap<FloatRGB> &bitmap) {
+static void invertColor(const BitmapRef<FloatRGB> &bitmap) {
+    for (int y = 0; y < bitmap.height(); ++y)
+        for (int x = 0; x < bitmap.width(); ++x) {
+            bitmap(x, y).r = 1.f-bitmap(x, y).r;
+            bitmap(x, y).g = 1.f-bitmap(x, y).g;
+            bitmap(x, y).b = 1.f-bitmap(x, y).b;
+        }
+}
+
+static void invertColor(const BitmapRef<FloatRGBA> &bitmap) {
     for (int y = 0; y < bitmap.height(); ++y)
         for (int x = 0; x < bitmap.width(); ++x) {
             bitmap(x, y).r = 1.f-bitmap(x, y).r;
             bitmap(x, y).g = 1.f-bitmap(x, y).g;
             bitmap(x, y).b = 1.f-bitmap(x, y).b;
+            bitmap(x, y).a = 1.f-bitmap(x, y).a;
         }
 }
 
-static void invertColor(Bitmap<float> &bitmap) {
+static void invertColor(const BitmapRef<float> &bitmap) {
     for (int y = 0; y < bitmap.height(); ++y)
         for (int x = 0; x < bitmap.width(); ++x)
             bitmap(x, y) = 1.f-bitmap(x, y);
 }
 
+static void invertColor(const BitmapRef<ByteRGB> &bitmap) {
+    for (int y = 0; y < bitmap.height(); ++y)
+        for (int x = 0; x < bitmap.width(); ++x) {
+            bitmap(x, y).r = 0xff-bitmap(x, y).r;
+            bitmap(x, y).g = 0xff-bitmap(x, y).g;
+            bitmap(x, y).b = 0xff-bitmap(x, y).b;
+        }
+}
+
+static void invertColor(const BitmapRef<ByteRGBA> &bitmap) {
+    for (int y = 0; y < bitmap.height(); ++y)
+        for (int x = 0; x < bitmap.width(); ++x) {
+            bitmap(x, y).r = 0xff-bitmap(x, y).r;
+            bitmap(x, y).g = 0xff-bitmap(x, y).g;
+            bitmap(x, y).b = 0xff-bitmap(x, y).b;
+            bitmap(x, y).a = 0xff-bitmap(x, y).a;
+        }
+}
+
+static void invertColor(const BitmapRef<unsigned char> &bitmap) {
+    for (int y = 0; y < bitmap.height(); ++y)
+        for (int x = 0; x < bitmap.width(); ++x)
+            bitmap(x, y) = 0xff-bitmap(x, y);
+}
+
+/// Returns the channels of a pixel, which are stored contiguously, as an array.
+static const float * pixelChannels(const float &pixel) {
+    return &pixel;
+}
+
+static const float * pixelChannels(const FloatRGB &pixel) {
+    return &pixel.r;
+}
+
+static const float * pixelChannels(const FloatRGBA &pixel) {
+    return &pixel.r;
+}
+
+static const unsigned char * pixelChannels(const unsigned char &pixel) {
+    return &pixel;
+}
+
+static const unsigned char * pixelChannels(const ByteRGB &pixel) {
+    return &pixel.r;
+}
+
+static const unsigned char * pixelChannels(const ByteRGBA &pixel) {
+    return &pixel.r;
+}
+
 static bool writeTextBitmap(FILE *file, const float *values, int cols, int rows) {
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
@@ -237,6 +345,39 @@ static bool writeBinBitmapFloatBE(FILE *file, const float *values, int count)
     return true;
 }
 
+static bool writeTextBitmap(FILE *file, const unsigned char *values, int cols, int rows) {
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col)
+            fprintf(file, col ? " %02X" : "%02X", *values++);
+        fprintf(file, "\n");
+    }
+    return true;
+}
+
+static bool writeBinBitmap(FILE *file, const unsigned char *values, int count) {
+    return fwrite(values, 1, count, file) == (size_t) count;
+}
+
+// 8-bit values are written as floats in the range from 0 to 1
+static std::vector<float> bytesToFloats(const unsigned char *values, int count) {
+    std::vector<float> floats(count);
+    for (int pos = 0; pos < count; ++pos)
+        floats[pos] = values[pos]/255.f;
+    return floats;
+}
+
+static bool writeTextBitmapFloat(FILE *file, const unsigned char *values, int cols, int rows) {
+    return writeTextBitmapFloat(file, &bytesToFloats(values, cols*rows)[0], cols, rows);
+}
+
+static bool writeBinBitmapFloat(FILE *file, const unsigned char *values, int count) {
+    return writeBinBitmapFloat(file, &bytesToFloats(values, count)[0], count);
+}
+
+static bool writeBinBitmapFloatBE(FILE *file, const unsigned char *values, int count) {
+    return writeBinBitmapFloatBE(file, &bytesToFloats(values, count)[0], count);
+}
+
 static bool cmpExtension(const char *path, const char *ext) {
     for (const char *a = path+strlen(path)-1, *b = ext+strlen(ext)-1; b >= ext; --a, --b)
         if (a < path || toupper(*a) != toupper(*b))
@@ -244,16 +385,41 @@ static bool cmpExtension(const char *path, const char *ext) {
     return true;
 }
 
+/// Returns the output format that corresponds to the extension of the file name, or AUTO if there is none.
+static Format deduceFormat(const char *filename) {
+    if (cmpExtension(filename, ".png")) return PNG;
+    if (cmpExtension(filename, ".bmp")) return BMP;
+    if (cmpExtension(filename, ".txt")) return TEXT;
+    if (cmpExtension(filename, ".bin")) return BINARY;
+	if (cmpExtension(filename, ".dds")) return DDS;
+    return AUTO;
+}
+
+/// Writes the rows of a Bitmap or BitmapRef in a text or binary format.
+template <class B>
+static bool writeValueRows(FILE *file, const B &bitmap, Format format) {
+    bool success = true;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        const auto *values = pixelChannels(*bitmap.row(y));
+        int cols = sizeof(*bitmap.row(y))/sizeof(*values)*bitmap.width();
+        switch (format) {
+            case AUTO: case TEXT: success &= writeTextBitmap(file, values, cols, 1); break;
+            case TEXT_FLOAT: success &= writeTextBitmapFloat(file, values, cols, 1); break;
+            case BINARY: success &= writeBinBitmap(file, values, cols); break;
+            case BINARY_FLOAT: success &= writeBinBitmapFloat(file, values, cols); break;
+            case BINART_FLOAT_BE: success &= writeBinBitmapFloatBE(file, values, cols); break;
+            default: return false;
+        }
+    }
+    return success;
+}
+
 template <typename T>
 static const char * writeOutput(const Bitmap<T> &bitmap, const char *filename, Format format) {
     if (filename) {
         if (format == AUTO) {
-            if (cmpExtension(filename, ".png")) format = PNG;
-            else if (cmpExtension(filename, ".bmp")) format = BMP;
-            else if (cmpExtension(filename, ".txt")) format = TEXT;
-            else if (cmpExtension(filename, ".bin")) format = BINARY;
-			else if (cmpExtension(filename, ".dds")) format = DDS;
-            else
+            format = deduceFormat(filename);
+            if (format == AUTO)
                 return "Could not deduce format from output file name.";
         }
         switch (format) {
@@ -263,22 +429,14 @@ static const char * writeOutput(const Bitmap<T> &bitmap, const char *filename, F
             case TEXT: case TEXT_FLOAT: {
                 FILE *file = fopen(filename, "w");
                 if (!file) return "Failed to write output text file.";
-                if (format == TEXT)
-                    writeTextBitmap(file, reinterpret_cast<const float *>(&bitmap(0, 0)), sizeof(T)/sizeof(float)*bitmap.width(), bitmap.height());
-                else if (format == TEXT_FLOAT)
-                    writeTextBitmapFloat(file, reinterpret_cast<const float *>(&bitmap(0, 0)), sizeof(T)/sizeof(float)*bitmap.width(), bitmap.height());
+                writeValueRows(file, bitmap, format);
                 fclose(file);
                 return NULL;
             }
             case BINARY: case BINARY_FLOAT: case BINART_FLOAT_BE: {
                 FILE *file = fopen(filename, "wb");
                 if (!file) return "Failed to write output binary file.";
-                if (format == BINARY)
-                    writeBinBitmap(file, reinterpret_cast<const float *>(&bitmap(0, 0)), sizeof(T)/sizeof(float)*bitmap.width()*bitmap.height());
-                else if (format == BINARY_FLOAT)
-                    writeBinBitmapFloat(file, reinterpret_cast<const float *>(&bitmap(0, 0)), sizeof(T)/sizeof(float)*bitmap.width()*bitmap.height());
-                else if (format == BINART_FLOAT_BE)
-                    writeBinBitmapFloatBE(file, reinterpret_cast<const float *>(&bitmap(0, 0)), sizeof(T)/sizeof(float)*bitmap.width()*bitmap.height());
+                writeValueRows(file, bitmap, format);
                 fclose(file);
                 return NULL;
             }
@@ -287,52 +445,404 @@ static const char * writeOutput(const Bitmap<T> &bitmap, const char *filename, F
                 break;
         }
     } else {
-        if (format == AUTO || format == TEXT)
-            writeTextBitmap(stdout, reinterpret_cast<const float *>(&bitmap(0, 0)), sizeof(T)/sizeof(float)*bitmap.width(), bitmap.height());
-        else if (format == TEXT_FLOAT)
-            writeTextBitmapFloat(stdout, reinterpret_cast<const float *>(&bitmap(0, 0)), sizeof(T)/sizeof(float)*bitmap.width(), bitmap.height());
+        if (format == AUTO || format == TEXT || format == TEXT_FLOAT)
+            writeValueRows(stdout, bitmap, format);
         else
             return "Unsupported format for standard output.";
     }
     return NULL;
 }
 
-void PackGlyphs(std::vector<Glyph>& glyphs, int glyphSize, int& width, int& height) {
-	stbrp_context context;
-	//calc possible size
-	int w = (int)sqrt(glyphSize * glyphSize * glyphs.size()) + 1;
-	w = (w + glyphSize - 1) & ~(glyphSize - 1); //make image divisable by four to make sure compression can work
-	stbrp_node* nodes = (stbrp_node*)malloc(w * 2 * sizeof(stbrp_node));
-	width = w; height = w;
-	stbrp_init_target(&context, w, w, nodes, w * 2);
-	stbrp_rect* rects = (stbrp_rect*)malloc(glyphs.size() * sizeof(stbrp_rect));
-	//build rects
-	//TODO: Pack them into smaller rectangles than the base size based on metrics
-	for (unsigned i = 0; i < glyphs.size(); ++i) {
-		rects[i].w = glyphSize;
-		rects[i].h = glyphSize;
-		rects[i].id = i;
+/// Starts writing an image of width x height pixels in parts, whose rows are then appended from the bottom up by writeOutputRows.
+/// Only the formats that store rows in this order are supported. The format must not be AUTO, unless the output is stdout.
+template <typename T>
+static const char * beginOutputRows(FILE *&file, const char *filename, Format format, int width, int height) {
+    if (!filename) {
+        if (format != AUTO && format != TEXT && format != TEXT_FLOAT)
+            return "Unsupported format for standard output.";
+        file = stdout;
+        return NULL;
+    }
+    switch (format) {
+        case BMP: case TEXT: case TEXT_FLOAT: case BINARY: case BINARY_FLOAT: case BINART_FLOAT_BE:
+            break;
+        case AUTO:
+            return "Could not deduce format from output file name.";
+        default:
+            return "The output format cannot be written in parts. Use BMP, text or binary output with -membudget.";
+    }
+    file = fopen(filename, format == TEXT || format == TEXT_FLOAT ? "w" : "wb");
+    if (!file)
+        return "Failed to write output file.";
+    if (format == BMP && !writeBmpHeader(file, width, height, sizeof(T)/sizeof(*pixelChannels(T())) == 4 ? 4 : 3))
+        return "Failed to write output BMP image.";
+    return NULL;
+}
+
+/// Appends rows to an image started by beginOutputRows.
+template <typename T>
+static bool writeOutputRows(FILE *file, const BitmapRef<T> &rows, Format format) {
+    if (format == BMP)
+        return writeBmpRows(file, rows);
+    return writeValueRows(file, rows, format);
+}
+
+/// The parameters of the distance fields of the glyphs.
+struct GeneratorSettings {
+	Mode mode;
+	bool legacy, edgeMajor, skipSaturated;
+	FillRule fillRule;
+	double edgeThreshold;
+	/// Set if the shapes are oriented in reverse, which the legacy generators do not account for.
+	bool invert;
+};
+
+template <typename T>
+static void generateSingleChannelGlyph(const BitmapRef<T> &output, const Glyph &g, const GeneratorSettings &settings) {
+	PreparedShape shape(g.shape);
+	if (settings.mode == PSEUDO) {
+		if (settings.legacy)
+			generatePseudoSDF_legacy(output, shape, g.range, g.scale, g.translate);
+		else if (settings.edgeMajor)
+			generatePseudoSDF_edgeMajor(output, shape, g.range, g.scale, g.translate, settings.fillRule);
+		else
+			generatePseudoSDF(output, shape, g.range, g.scale, g.translate, settings.skipSaturated, settings.fillRule);
+	} else {
+		if (settings.legacy)
+			generateSDF_legacy(output, shape, g.range, g.scale, g.translate);
+		else if (settings.edgeMajor)
+			generateSDF_edgeMajor(output, shape, g.range, g.scale, g.translate, settings.fillRule);
+		else
+			generateSDF(output, shape, g.range, g.scale, g.translate, settings.skipSaturated, settings.fillRule);
 	}
-	
-	stbrp_pack_rects(&context, rects, glyphs.size());
+}
 
-	for (unsigned i = 0; i < glyphs.size(); ++i) {
-		glyphs[i].x = rects[i].x;
-		glyphs[i].y = rects[i].y;
+template <typename T>
+static void generateMultiChannelGlyph(const BitmapRef<T> &output, const Glyph &g, const GeneratorSettings &settings) {
+	PreparedShape shape(g.shape);
+	if (settings.legacy)
+		generateMSDF_legacy(output, shape, g.range, g.scale, g.translate, settings.edgeThreshold);
+	else if (settings.edgeMajor)
+		generateMSDF_edgeMajor(output, shape, g.range, g.scale, g.translate, settings.edgeThreshold, settings.fillRule);
+	else
+		generateMSDF(output, shape, g.range, g.scale, g.translate, settings.edgeThreshold, settings.skipSaturated, settings.fillRule);
+}
+
+template <typename T>
+static void generateMultiAndTrueGlyph(const BitmapRef<T> &output, const Glyph &g, const GeneratorSettings &settings) {
+	PreparedShape shape(g.shape);
+	if (settings.legacy)
+		generateMTSDF_legacy(output, shape, g.range, g.scale, g.translate, settings.edgeThreshold);
+	else if (settings.edgeMajor)
+		generateMTSDF_edgeMajor(output, shape, g.range, g.scale, g.translate, settings.edgeThreshold, settings.fillRule);
+	else
+		generateMTSDF(output, shape, g.range, g.scale, g.translate, settings.edgeThreshold, settings.skipSaturated, settings.fillRule);
+}
+
+/// Generates the distance field of a glyph of the kind that matches the pixel type of the output.
+static void generateGlyph(const BitmapRef<float> &output, const Glyph &g, const GeneratorSettings &settings) {
+	generateSingleChannelGlyph(output, g, settings);
+}
+
+static void generateGlyph(const BitmapRef<unsigned char> &output, const Glyph &g, const GeneratorSettings &settings) {
+	generateSingleChannelGlyph(output, g, settings);
+}
+
+static void generateGlyph(const BitmapRef<FloatRGB> &output, const Glyph &g, const GeneratorSettings &settings) {
+	generateMultiChannelGlyph(output, g, settings);
+}
+
+static void generateGlyph(const BitmapRef<ByteRGB> &output, const Glyph &g, const GeneratorSettings &settings) {
+	generateMultiChannelGlyph(output, g, settings);
+}
+
+static void generateGlyph(const BitmapRef<FloatRGBA> &output, const Glyph &g, const GeneratorSettings &settings) {
+	generateMultiAndTrueGlyph(output, g, settings);
+}
+
+static void generateGlyph(const BitmapRef<ByteRGBA> &output, const Glyph &g, const GeneratorSettings &settings) {
+	generateMultiAndTrueGlyph(output, g, settings);
+}
+
+/// Generates the distance field of a glyph and measures its reconstruction error at refWidth x refHeight pixels.
+static double measureGlyphError(const Glyph &g, const GeneratorSettings &settings, int refWidth, int refHeight) {
+	switch (settings.mode) {
+		case MULTI: {
+			Bitmap<FloatRGB> msdf(g.width, g.height);
+			generateGlyph(msdf, g, settings);
+			if (settings.invert)
+				invertColor(msdf);
+			return measureReconstructionError(msdf, g.shape, g.scale, g.translate, refWidth, refHeight, settings.fillRule);
+		}
+		case MULTI_AND_TRUE: {
+			// The outline is reconstructed from the color channels
+			Bitmap<FloatRGBA> mtsdf(g.width, g.height);
+			generateGlyph(mtsdf, g, settings);
+			if (settings.invert)
+				invertColor(mtsdf);
+			Bitmap<FloatRGB> msdf(g.width, g.height);
+			for (int y = 0; y < g.height; ++y)
+				for (int x = 0; x < g.width; ++x) {
+					msdf(x, y).r = mtsdf(x, y).r;
+					msdf(x, y).g = mtsdf(x, y).g;
+					msdf(x, y).b = mtsdf(x, y).b;
+				}
+			return measureReconstructionError(msdf, g.shape, g.scale, g.translate, refWidth, refHeight, settings.fillRule);
+		}
+		default: {
+			Bitmap<float> sdf(g.width, g.height);
+			generateGlyph(sdf, g, settings);
+			if (settings.invert)
+				invertColor(sdf);
+			return measureReconstructionError(sdf, g.shape, g.scale, g.translate, refWidth, refHeight, settings.fillRule);
+		}
+	}
+}
+
+/** A band of rows of the atlas, whose buffer the distance fields of the glyphs are generated in.
+ *  The pixel type is chosen by the mode and the output format: formats with 8 bits per channel get 8-bit pixels,
+ *  which are quantized as they are generated, so the atlas takes a quarter of the memory of a floating-point one.
+ */
+class AtlasBand {
+
+public:
+	virtual ~AtlasBand() { }
+	/// Generates the distance field of a glyph, where y0 is the row of the atlas at the top of the band.
+	virtual void generateGlyph(const Glyph &g, int y0, const GeneratorSettings &settings) = 0;
+	/// Starts writing an atlas of the given height in parts. See beginOutputRows.
+	virtual const char * beginOutput(FILE *&file, const char *filename, Format format, int atlasHeight) const = 0;
+	/// Writes the first rows of the band to the output, and moves the rows below them, which belong to glyphs
+	/// that continue into the next band, to the beginning of the buffer.
+	virtual bool flush(FILE *file, Format format, int rows) = 0;
+	/// Writes the buffer as the whole atlas.
+	virtual const char * write(const char *filename, Format format) const = 0;
+	/// Reads the distance field of a glyph from a file of the glyph cache. Returns false if it does not match the glyph's cell.
+	virtual bool readGlyph(FILE *file, const Glyph &g, int y0) = 0;
+	/// Writes the distance field of a glyph to a file of the glyph cache.
+	virtual bool writeGlyph(FILE *file, const Glyph &g, int y0) const = 0;
+
+};
+
+template <typename T>
+class AtlasBandOf : public AtlasBand {
+
+public:
+	/// The buffer is zeroed, so that the space between glyphs is deterministic.
+	AtlasBandOf(int width, int height) : bitmap(width, height) {
+		std::fill(bitmap.row(0), bitmap.row(height), T());
+	}
+	void generateGlyph(const Glyph &g, int y0, const GeneratorSettings &settings) {
+		BitmapRef<T> output = BitmapRef<T>(bitmap).region(g.x, g.y-y0, g.width, g.height);
+		::generateGlyph(output, g, settings);
+		// Only the legacy generators take the sign from the orientation of the edges rather than the fill rule
+		if (settings.invert)
+			invertColor(output);
+	}
+	const char * beginOutput(FILE *&file, const char *filename, Format format, int atlasHeight) const {
+		return beginOutputRows<T>(file, filename, format, bitmap.width(), atlasHeight);
+	}
+	bool flush(FILE *file, Format format, int rows) {
+		bool success = writeOutputRows(file, BitmapRef<T>(bitmap).region(0, 0, bitmap.width(), rows), format);
+		std::copy(bitmap.row(rows), bitmap.row(bitmap.height()), bitmap.row(0));
+		std::fill(bitmap.row(bitmap.height()-rows), bitmap.row(bitmap.height()), T());
+		return success;
+	}
+	const char * write(const char *filename, Format format) const {
+		return writeOutput(bitmap, filename, format);
+	}
+	bool readGlyph(FILE *file, const Glyph &g, int y0) {
+		int header[3];
+		if (fread(header, sizeof(header), 1, file) != 1 || header[0] != g.width || header[1] != g.height || header[2] != (int) sizeof(T))
+			return false;
+		BitmapRef<T> output = BitmapRef<T>(bitmap).region(g.x, g.y-y0, g.width, g.height);
+		for (int y = 0; y < g.height; ++y) {
+			if (fread(output.row(y), sizeof(T), g.width, file) != (size_t) g.width)
+				return false;
+		}
+		return true;
+	}
+	bool writeGlyph(FILE *file, const Glyph &g, int y0) const {
+		int header[3] = { g.width, g.height, (int) sizeof(T) };
+		if (fwrite(header, sizeof(header), 1, file) != 1)
+			return false;
+		for (int y = 0; y < g.height; ++y) {
+			if (fwrite(bitmap.row(g.y-y0+y)+g.x, sizeof(T), g.width, file) != (size_t) g.width)
+				return false;
+		}
+		return true;
 	}
 
-	free(rects);
-	free(nodes);
+private:
+	Bitmap<T> bitmap;
+
+};
+
+/// Creates the buffer of a band of the atlas for the output of the mode, or returns NULL if the mode has none.
+static AtlasBand * createAtlasBand(Mode mode, bool byteAtlas, int width, int height) {
+	switch (mode) {
+		case SINGLE: case PSEUDO:
+			if (byteAtlas)
+				return new AtlasBandOf<unsigned char>(width, height);
+			return new AtlasBandOf<float>(width, height);
+		case MULTI:
+			if (byteAtlas)
+				return new AtlasBandOf<ByteRGB>(width, height);
+			return new AtlasBandOf<FloatRGB>(width, height);
+		case MULTI_AND_TRUE:
+			if (byteAtlas)
+				return new AtlasBandOf<ByteRGBA>(width, height);
+			return new AtlasBandOf<FloatRGBA>(width, height);
+		default:
+			return NULL;
+	}
 }
 
-void WriteGlyphsToAtlas(std::vector<Glyph>& glyphs, int glyphSize, Bitmap<FloatRGB>& atlas) {
-	for (auto& g : glyphs) {
-		for (int y = 0; y < glyphSize; ++y) {
-			for (int x = 0; x < glyphSize; ++x) {
-				atlas(g.x + x, g.y + y) = g.bitmap(x, y);
+/// Accumulates a 64-bit FNV-1a hash.
+class Hash {
+
+public:
+	Hash() : value(0xcbf29ce484222325ull) { }
+	void add(const void *data, size_t size) {
+		for (size_t i = 0; i < size; ++i) {
+			value ^= static_cast<const unsigned char *>(data)[i];
+			value *= 0x100000001b3ull;
+		}
+	}
+	template <typename T>
+	void add(const T &data) {
+		add(&data, sizeof(data));
+	}
+	unsigned long long value;
+
+};
+
+/// Revision of the glyph cache. It must be incremented whenever the layout of its files or the output of the generators
+/// changes for the same inputs, since MSDFGEN_VERSION is not, so that distance fields of earlier builds are not reused.
+#define GLYPH_CACHE_REVISION 2
+
+/// Returns the path of the file of the glyph cache that holds the distance field of a glyph with colored edges.
+/// It is named by a hash of everything the distance field depends on: the version of the generators, the distance kernels
+/// they use and their settings, the pixel size of the atlas, the framing of the cell and the outline of the glyph.
+static std::string glyphCacheFile(const char *directory, const Glyph &g, const GeneratorSettings &settings, size_t pixelSize) {
+	Hash hash;
+	hash.add(MSDFGEN_VERSION, sizeof(MSDFGEN_VERSION));
+	hash.add(GLYPH_CACHE_REVISION);
+	// The single-precision kernels selected by MSDFGEN_FLOAT_KERNELS produce slightly different pixels
+	const char *kernels = edgeKernels().name;
+	hash.add(kernels, strlen(kernels)+1);
+	hash.add(settings.mode);
+	hash.add(settings.legacy);
+	hash.add(settings.edgeMajor);
+	hash.add(settings.skipSaturated);
+	hash.add(settings.fillRule);
+	hash.add(settings.edgeThreshold);
+	hash.add(settings.invert);
+	hash.add(pixelSize);
+	hash.add(g.width);
+	hash.add(g.height);
+	hash.add(g.scale.x);
+	hash.add(g.scale.y);
+	hash.add(g.translate.x);
+	hash.add(g.translate.y);
+	hash.add(g.range);
+	FlatShape shape(g.shape);
+	hash.add(shape.inverseYAxis);
+	hash.add(&shape.contourStarts[0], shape.contourStarts.size()*sizeof(int));
+	for (int edge = 0; edge < shape.edgeCount(); ++edge) {
+		const Point2 *points;
+		int degree = shape.controlPoints(edge, points);
+		hash.add(shape.edgeColors[edge]);
+		hash.add(degree);
+		for (int i = 0; i <= degree; ++i) {
+			hash.add(points[i].x);
+			hash.add(points[i].y);
+		}
+	}
+	char name[24];
+	sprintf(name, "%016llx.field", hash.value);
+	return std::string(directory)+"/"+name;
+}
+
+/// Returns the number of bytes of a row of the buffer of a band of the given width created by createAtlasBand, including its padding.
+static size_t atlasRowSize(Mode mode, bool byteAtlas, int width) {
+	switch (mode) {
+		case SINGLE: case PSEUDO:
+			if (byteAtlas)
+				return Bitmap<unsigned char>::strideOf(width)*sizeof(unsigned char);
+			return Bitmap<float>::strideOf(width)*sizeof(float);
+		case MULTI:
+			if (byteAtlas)
+				return Bitmap<ByteRGB>::strideOf(width)*sizeof(ByteRGB);
+			return Bitmap<FloatRGB>::strideOf(width)*sizeof(FloatRGB);
+		case MULTI_AND_TRUE:
+			if (byteAtlas)
+				return Bitmap<ByteRGBA>::strideOf(width)*sizeof(ByteRGBA);
+			return Bitmap<FloatRGBA>::strideOf(width)*sizeof(FloatRGBA);
+		default:
+			return 0;
+	}
+}
+
+/// Returns the file name of a page of an atlas of several pages, which has the index of the page inserted before the extension.
+static std::string pageFileName(const char *filename, int page) {
+	std::string name(filename);
+	size_t extension = name.find_last_of('.');
+	if (extension == std::string::npos || name.find_first_of("/\\", extension) != std::string::npos)
+		extension = name.size();
+	return name.insert(extension, "_"+std::to_string(page));
+}
+
+/// Packs the cells of the glyphs into pages of the atlas. Each page starts as the smallest square that could hold the total area
+/// of the remaining cells, which is enlarged until they all fit or it reaches maxSize (unless zero), in which case the cells
+/// that do not fit spill into the next page. The height of each page is then trimmed to the rows in use.
+/// Glyphs with empty cells are placed at the origin of the first page. Returns false if a cell exceeds maxSize.
+bool PackGlyphs(std::vector<Glyph>& glyphs, int maxSize, std::vector<AtlasPage>& pages) {
+	std::vector<stbrp_rect> remaining(glyphs.size());
+	for (unsigned i = 0; i < glyphs.size(); ++i) {
+		remaining[i].w = glyphs[i].width;
+		remaining[i].h = glyphs[i].height;
+		remaining[i].id = i;
+	}
+	maxSize &= ~3;
+	while (!remaining.empty()) {
+		long long area = 0;
+		int w = 1;
+		for (const stbrp_rect& r : remaining) {
+			area += (long long) r.w * r.h;
+			w = max(w, (int) r.w);
+		}
+		w = max(w, (int)ceil(sqrt((double)area)));
+		for (;; w += max(w / 8, 4)) {
+			w = (w + 3) & ~3; //make image divisable by four to make sure compression can work
+			if (maxSize)
+				w = min(w, maxSize);
+			std::vector<stbrp_node> nodes(w);
+			stbrp_context context;
+			stbrp_init_target(&context, w, w, &nodes[0], w);
+			if (stbrp_pack_rects(&context, &remaining[0], remaining.size()) || w == maxSize)
+				break;
+		}
+
+		AtlasPage page = { w, 0 };
+		std::vector<stbrp_rect> spilled;
+		for (const stbrp_rect& r : remaining) {
+			if (!r.was_packed) {
+				spilled.push_back(r);
+				continue;
 			}
+			Glyph& g = glyphs[r.id];
+			g.x = r.x;
+			g.y = r.y;
+			g.page = (int) pages.size();
+			page.height = max(page.height, r.y + r.h);
 		}
+		if (spilled.size() == remaining.size())
+			return false;
+		page.height = max((page.height + 3) & ~3, 4);
+		pages.push_back(page);
+		remaining.swap(spilled);
 	}
+	return true;
 }
 
 void ConvertJsonToSjson(std::string& in) {
@@ -345,13 +855,19 @@ void ConvertJsonToSjson(std::string& in) {
 		in[in.size() - 1] = ' ';
 }
 
-void SerializeGlyphs(const std::vector<Glyph>& glyphs,int charSize, int atlasWidth, int atlasHeight, const char* filename) {
+void SerializeGlyphs(const std::vector<Glyph>& glyphs,int charSize, const std::vector<AtlasPage>& pages, const char* filename) {
 	using namespace nlohmann;
 	std::stringstream ss;
 	try {
 		json root;
-		root["width"] = atlasWidth;
-		root["height"] = atlasHeight;
+		root["width"] = pages[0].width;
+		root["height"] = pages[0].height;
+		for (auto& page : pages) {
+			json o;
+			o["width"] = page.width;
+			o["height"] = page.height;
+			root["pages"].push_back(o);
+		}
 		root["size"] = charSize;
 		root["line_height"] = 45; //TODO: Figure out what these do
 		root["base_line"] = 35;
@@ -365,6 +881,8 @@ void SerializeGlyphs(const std::vector<Glyph>& glyphs,int charSize, int atlasWid
 			o["height"] = g.height;
 			o["xoffset"] = g.xoffset;
 			o["yoffset"] = g.yoffset;
+			o["page"] = g.page;
+			o["size"] = g.size;
 			root["glyphs"].push_back(o);
 		}
 		ss << std::setw(4) << root;
@@ -398,6 +916,7 @@ static const char *helpText =
     "  sdf - Generate conventional monochrome signed distance field.\n"
     "  psdf - Generate monochrome signed pseudo-distance field.\n"
     "  msdf - Generate multi-channel signed distance field. This is used by default if no mode is specified.\n"
+    "  mtsdf - Generate multi-channel signed distance field with true signed distance in the alpha channel.\n"
     "  metrics - Report shape metrics only.\n"
     "\n"
     "INPUT SPECIFICATION\n"
@@ -413,44 +932,65 @@ static const char *helpText =
         "\tLoads the last vector path found in the specified SVG file.\n"
     "\n"
     "OPTIONS\n"
+    "  -adaptivesize <error>\n"
+        "\tGenerates each glyph in the smallest frame whose reconstructed outline is on average within error pixels of the shape at -size.\n"
     "  -angle <angle>\n"
         "\tSpecifies the minimum angle between adjacent edges to be considered a corner. Append D for degrees.\n"
     "  -ascale <x scale> <y scale>\n"
         "\tSets the scale used to convert shape units to pixels asymmetrically.\n"
     "  -autoframe\n"
         "\tAutomatically scales (unless specified) and translates the shape to fit.\n"
+    "  -cache <directory>\n"
+        "\tReuses the distance fields of glyphs generated before with the same outline and parameters from an existing directory.\n"
     "  -edgecolors <sequence>\n"
         "\tOverrides automatic edge coloring with the specified color sequence.\n"
+    "  -edgemajor\n"
+        "\tEvaluates each edge only near the outline and determines the sign by the winding number. Saturates pixels outside the range.\n"
     "  -errorcorrection <threshold>\n"
         "\tChanges the threshold used to detect and correct potential artifacts. 0 disables error correction.\n"
     "  -exportshape <filename.txt>\n"
         "\tSaves the shape description into a text file that can be edited and loaded using -shapedesc.\n"
+    "  -fillrule <nonzero / evenodd / positive / negative>\n"
+        "\tSets the fill rule for the scanline pass, which determines the sign of each pixel. Ignored by -legacy.\n"
     "  -format <png / bmp / text / textfloat / bin / binfloat / binfloatbe>\n"
         "\tSpecifies the output format of the distance field. Otherwise it is chosen based on output file extension.\n"
     "  -help\n"
         "\tDisplays this help.\n"
     "  -keeporder\n"
         "\tDisables the detection of shape orientation and keeps it as is.\n"
+    "  -kernelcheck\n"
+        "\tPrints the maximum deviation of the distances and pseudo-distances of each set of distance kernels from the double-precision path.\n"
     "  -legacy\n"
         "\tUses the original (legacy) distance field algorithms.\n"
+    "  -maxpagesize <pixels>\n"
+        "\tLimits the width and height of the atlas. Glyphs that do not fit spill into further pages, numbered in the file names.\n"
+    "  -membudget <megabytes>\n"
+        "\tGenerates the atlas in bands of rows that fit in the memory budget and writes each band as soon as it is done.\n"
+        "\tOnly BMP, text and binary output is supported.\n"
     "  -o <filename>\n"
         "\tSets the output file name. The default value is \"output.png\".\n"
     "  -printmetrics\n"
-        "\tPrints relevant metrics of the shape to the standard output.\n"
+        "\tPrints the bounds, advance and framing of each glyph and the size of its cell to the standard output.\n"
     "  -pxrange <range>\n"
         "\tSets the width of the range between the lowest and highest signed distance in pixels.\n"
+    "  -quadratic <tolerance>\n"
+        "\tApproximates cubic curves by quadratic curves, which are faster to evaluate, within the tolerance in pixels.\n"
     "  -range <range>\n"
         "\tSets the width of the range between the lowest and highest signed distance in shape units.\n"
     "  -scale <scale>\n"
         "\tSets the scale used to convert shape units to pixels.\n"
     "  -size <width> <height>\n"
-        "\tSets the dimensions of the output image.\n"
+        "\tSets the dimensions of the frame of each glyph. Its cell in the atlas is cropped to the glyph's bounds plus the range.\n"
+    "  -skipsaturated\n"
+        "\tFills pixels farther than half the range from the shape without computing their distances. Only 8-bit output is exact.\n"
     "  -stdout\n"
         "\tPrints the output instead of storing it in a file. Only text formats are supported.\n"
     "  -testrender <filename.png> <width> <height>\n"
         "\tRenders an image preview using the generated distance field and saves it as a PNG file.\n"
     "  -testrendermulti <filename.png> <width> <height>\n"
         "\tRenders an image preview without flattening the color channels.\n"
+    "  -threads <n>\n"
+        "\tSets the number of threads used to generate the distance field. 0 (default) uses all hardware threads.\n"
     "  -translate <x> <y>\n"
         "\tSets the translation of the shape in shape units.\n"
     "  -reverseorder\n"
@@ -473,13 +1013,9 @@ int main(int argc, const char * const *argv) {
         DESCRIPTION_STDIN,
         DESCRIPTION_FILE
     } inputType = NONE;
-    enum {
-        SINGLE,
-        PSEUDO,
-        MULTI,
-        METRICS
-    } mode = MULTI;
+    Mode mode = MULTI;
     bool legacyMode = false;
+    bool edgeMajorMode = false;
     Format format = AUTO;
     const char *input = NULL;
     const char *output = "output.png";
@@ -517,6 +1053,15 @@ int main(int argc, const char * const *argv) {
         GUESS
     } orientation = GUESS;
     unsigned long long coloringSeed = 0;
+    int threadCount = 0;
+    bool skipSaturated = false;
+    FillRule fillRule = FILL_NONZERO;
+    double quadraticTolerance = 0;
+    bool kernelCheck = false;
+    unsigned long long memoryBudget = 0;
+    unsigned maxPageSize = 0;
+    double adaptiveError = 0;
+    const char *cacheDirectory = NULL;
 
     int argPos = 1;
     bool suggestHelp = false;
@@ -529,6 +1074,7 @@ int main(int argc, const char * const *argv) {
         ARG_MODE("sdf", SINGLE)
         ARG_MODE("psdf", PSEUDO)
         ARG_MODE("msdf", MULTI)
+        ARG_MODE("mtsdf", MULTI_AND_TRUE)
         ARG_MODE("metrics", METRICS)
 
         ARG_CASE("-svg", 1) {
@@ -578,6 +1124,35 @@ int main(int argc, const char * const *argv) {
             argPos += 1;
             continue;
         }
+        ARG_CASE("-maxpagesize", 1) {
+            if (!parseUnsigned(maxPageSize, argv[argPos+1]) || maxPageSize < 4)
+                ABORT("Invalid maximum page size. Use -maxpagesize <pixels> with an integer of at least 4.");
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-membudget", 1) {
+            unsigned mb;
+            if (!parseUnsigned(mb, argv[argPos+1]) || !mb)
+                ABORT("Invalid memory budget. Use -membudget <megabytes> with a positive integer.");
+            memoryBudget = (unsigned long long) mb<<20;
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-edgemajor", 0) {
+            edgeMajorMode = true;
+            argPos += 1;
+            continue;
+        }
+        ARG_CASE("-fillrule", 1) {
+            if (!strcmp(argv[argPos+1], "nonzero")) fillRule = FILL_NONZERO;
+            else if (!strcmp(argv[argPos+1], "evenodd") || !strcmp(argv[argPos+1], "odd")) fillRule = FILL_ODD;
+            else if (!strcmp(argv[argPos+1], "positive")) fillRule = FILL_POSITIVE;
+            else if (!strcmp(argv[argPos+1], "negative")) fillRule = FILL_NEGATIVE;
+            else
+                puts("Unknown fill rule specified.");
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-format", 1) {
             if (!strcmp(argv[argPos+1], "auto")) format = AUTO;
             else if (!strcmp(argv[argPos+1], "png")) SETFORMAT(PNG, "png");
@@ -651,6 +1226,12 @@ int main(int argc, const char * const *argv) {
             argPos += 3;
             continue;
         }
+        ARG_CASE("-adaptivesize", 1) {
+            if (!parseDouble(adaptiveError, argv[argPos+1]) || adaptiveError <= 0)
+                ABORT("Invalid adaptive size error. Use -adaptivesize <error> with a positive real number.");
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-angle", 1) {
             double at;
             if (!parseAngle(at, argv[argPos+1]))
@@ -667,6 +1248,11 @@ int main(int argc, const char * const *argv) {
             argPos += 2;
             continue;
         }
+        ARG_CASE("-cache", 1) {
+            cacheDirectory = argv[argPos+1];
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-edgecolors", 1) {
             static const char *allowed = " ?,cmyCMY";
             for (int i = 0; argv[argPos+1][i]; ++i) {
@@ -728,6 +1314,32 @@ int main(int argc, const char * const *argv) {
             argPos += 1;
             continue;
         }
+        ARG_CASE("-threads", 1) {
+            unsigned tc;
+            if (!parseUnsigned(tc, argv[argPos+1]))
+                ABORT("Invalid thread count. Use -threads <N> with N being a non-negative integer.");
+            threadCount = tc;
+            argPos += 2;
+            continue;
+        }
+        ARG_CASE("-skipsaturated", 0) {
+            skipSaturated = true;
+            argPos += 1;
+            continue;
+        }
+        ARG_CASE("-kernelcheck", 0) {
+            kernelCheck = true;
+            argPos += 1;
+            continue;
+        }
+        ARG_CASE("-quadratic", 1) {
+            double tolerance;
+            if (!parseDouble(tolerance, argv[argPos+1]) || tolerance <= 0)
+                ABORT("Invalid tolerance. Use -quadratic <tolerance> with a positive real number of pixels.");
+            quadraticTolerance = tolerance;
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-seed", 1) {
             if (!parseUnsignedLL(coloringSeed, argv[argPos+1]))
                 ABORT("Invalid seed. Use -seed <N> with N being a non-negative integer.");
@@ -748,6 +1360,16 @@ int main(int argc, const char * const *argv) {
     }
     if (suggestHelp)
         printf("Use -help for more information.\n");
+    setThreadCount(threadCount);
+    if (cacheDirectory) {
+        // Otherwise every glyph would be regenerated without notice
+        std::string probeFile = std::string(cacheDirectory)+"/.probe";
+        FILE *probe = fopen(probeFile.c_str(), "wb");
+        if (!probe)
+            ABORT("Cannot write to the glyph cache directory.");
+        fclose(probe);
+        remove(probeFile.c_str());
+    }
 
     // Load input
     Vector2 svgDims;
@@ -757,6 +1379,9 @@ int main(int argc, const char * const *argv) {
 
 	Shape shape;
 	std::vector<Glyph> glyphs;
+	// The font stays open, so that the glyphs can be reloaded when the atlas is generated in bands
+	FreetypeHandle *ft = NULL;
+	FontHandle *font = NULL;
 	if (unicode != 9608)
 		unicodes.push_back(unicode);
 	if (!unicodes.empty())
@@ -771,9 +1396,9 @@ int main(int argc, const char * const *argv) {
         case FONT: {
             if (!unicode)
                 ABORT("No character specified! Use -font <file.ttf/otf> <character code>. Character code can be a number (65, 0x41), or a character in apostrophes ('A').");
-            FreetypeHandle *ft = initializeFreetype();
+            ft = initializeFreetype();
             if (!ft) return -1;
-            FontHandle *font = loadFont(ft, input);
+            font = loadFont(ft, input);
             if (!font) {
                 deinitializeFreetype(ft);
                 ABORT("Failed to load font file.");
@@ -793,8 +1418,6 @@ int main(int argc, const char * const *argv) {
 				g.yoffset = 0;
 				glyphs.push_back(g);
 			}
-            destroyFont(font);
-            deinitializeFreetype(ft);
             break;
         }
         case DESCRIPTION_ARG: {
@@ -830,14 +1453,73 @@ int main(int argc, const char * const *argv) {
 		glyphs.push_back(g);
 	}
 
-	std::vector<Bitmap<float>> sdfList;
-    // Validate and normalize shape
+	auto prepareShape = [&](Shape &glyphShape) -> bool {
+		if (!glyphShape.validate())
+			return false;
+		glyphShape.normalize();
+		if (yFlip)
+			glyphShape.inverseYAxis = !glyphShape.inverseYAxis;
+		return true;
+	};
+
+	// Colors the edges of a glyph's shape and approximates its cubic curves for generation at the scale
+	auto finishShape = [&](Shape &glyphShape, const Vector2 &glyphScale) {
+		if (mode == MULTI || mode == MULTI_AND_TRUE) {
+			if (!skipColoring)
+				edgeColoringSimple(glyphShape, angleThreshold, coloringSeed);
+			if (edgeAssignment)
+				parseColoring(glyphShape, edgeAssignment);
+		}
+		// Follows the coloring, so that the edge color sequence refers to the original edges
+		if (quadraticTolerance > 0)
+			glyphShape.approximateCubics(quadraticTolerance/max(glyphScale.x, glyphScale.y));
+	};
+
+	GeneratorSettings settings;
+	settings.mode = mode;
+	settings.legacy = legacyMode;
+	settings.edgeMajor = edgeMajorMode;
+	settings.skipSaturated = skipSaturated;
+	settings.fillRule = fillRule;
+	settings.edgeThreshold = edgeThreshold;
+	settings.invert = false;
+
+	// The bounds of a glyph and its framing in the frame of width x height pixels
+	struct GlyphFrame {
+		double l, b, r, t;
+		Vector2 scale, translate;
+		double range;
+	};
+	std::vector<GlyphFrame> frames(glyphs.size());
+
+	// The cell of a glyph only covers its bounds extended by the range, within its frame,
+	// which is the frame of width x height pixels reduced by factor
+	auto frameCell = [&](Glyph &g, const GlyphFrame &frame, double factor) {
+		Vector2 cellScale = factor*frame.scale;
+		double cellRange = rangeMode == RANGE_PX ? pxRange/min(cellScale.x, cellScale.y) : frame.range;
+		// A reduced frame is extended by the growth of the range in shape units, so that it does not crop the range
+		int marginX = (int) ceil((cellRange-frame.range)*cellScale.x), marginY = (int) ceil((cellRange-frame.range)*cellScale.y);
+		int frameWidth = (int) ceil(factor*width)+marginX, frameHeight = (int) ceil(factor*height)+marginY;
+		Vector2 cellTranslate = frame.translate;
+		if (frame.l < frame.r && frame.b < frame.t) {
+			int x0 = max((int) floor((frame.l-cellRange+frame.translate.x)*cellScale.x), -marginX);
+			int y0 = max((int) floor((frame.b-cellRange+frame.translate.y)*cellScale.y), -marginY);
+			int x1 = min((int) ceil((frame.r+cellRange+frame.translate.x)*cellScale.x), frameWidth);
+			int y1 = min((int) ceil((frame.t+cellRange+frame.translate.y)*cellScale.y), frameHeight);
+			g.width = max(x1-x0, 0);
+			g.height = max(y1-y0, 0);
+			cellTranslate -= Vector2(x0/cellScale.x, y0/cellScale.y);
+		} else
+			g.width = 0, g.height = 0;
+		g.scale = cellScale;
+		g.translate = cellTranslate;
+		g.range = cellRange;
+	};
+
+    // Validate, normalize and frame shapes
 	for (auto& g : glyphs) {
-		if (!g.shape.validate())
+		if (!prepareShape(g.shape))
 			ABORT("The geometry of the loaded shape is invalid.");
-		g.shape.normalize();
-		if (yFlip)
-			g.shape.inverseYAxis = !g.shape.inverseYAxis;
 
 		double avgScale = .5*(scale.x + scale.y);
 		struct {
@@ -845,8 +1527,7 @@ int main(int argc, const char * const *argv) {
 		} bounds = {
 			LARGE_VALUE, LARGE_VALUE, -LARGE_VALUE, -LARGE_VALUE
 		};
-		if (autoFrame || mode == METRICS || printMetrics || orientation == GUESS)
-			g.shape.bounds(bounds.l, bounds.b, bounds.r, bounds.t);
+		g.shape.bounds(bounds.l, bounds.b, bounds.r, bounds.t);
 		// Auto-frame
 		if (autoFrame) {
 			double l = bounds.l, b = bounds.b, r = bounds.r, t = bounds.t;
@@ -879,43 +1560,14 @@ int main(int argc, const char * const *argv) {
 
 		if (rangeMode == RANGE_PX)
 			range = pxRange/min(scale.x, scale.y);
-	
 
-		// Compute output
-		Bitmap<float> sdf;
-		Bitmap<FloatRGB> msdf;
-		switch (mode) {
-			case SINGLE: {
-				sdf = Bitmap<float>(width, height);
-				if (legacyMode)
-					generateSDF_legacy(sdf, g.shape, range, scale, translate);
-				else
-					generateSDF(sdf, g.shape, range, scale, translate);
-				break;
-			}
-			case PSEUDO: {
-				sdf = Bitmap<float>(width, height);
-				if (legacyMode)
-					generatePseudoSDF_legacy(sdf, g.shape, range, scale, translate);
-				else
-					generatePseudoSDF(sdf, g.shape, range, scale, translate);
-				break;
-			}
-			case MULTI: {
-				if (!skipColoring)
-					edgeColoringSimple(g.shape, angleThreshold, coloringSeed);
-				if (edgeAssignment)
-					parseColoring(g.shape, edgeAssignment);
-				g.bitmap = Bitmap<FloatRGB>(width, height);
-				if (legacyMode)
-					generateMSDF_legacy(g.bitmap, g.shape, range, scale, translate, edgeThreshold);
-				else
-					generateMSDF(g.bitmap, g.shape, range, scale, translate, edgeThreshold);
-				break;
-			}
-			default:
-				break;
-		}
+		GlyphFrame &frame = frames[&g-&glyphs[0]];
+		frame.l = bounds.l, frame.b = bounds.b, frame.r = bounds.r, frame.t = bounds.t;
+		frame.scale = scale;
+		frame.translate = translate;
+		frame.range = range;
+		frameCell(g, frame, 1);
+		g.size = width;
 
 		if (orientation == GUESS) {
 			// Get sign of signed distance outside bounds
@@ -930,34 +1582,253 @@ int main(int argc, const char * const *argv) {
 				}
 			orientation = minDistance.distance <= 0 ? KEEP : REVERSE;
 		}
-		if (orientation == REVERSE) {
-			invertColor(sdf);
-			invertColor(g.bitmap);
-		}
 
 		//update data
 		g.advance = bounds.r + bounds.l;
-		g.xoffset = -translate.x;
-		g.yoffset = translate.y;
-	}
-	//collect glyphs
-	int atlasWidth, atlasHeight;
-	PackGlyphs(glyphs, width, atlasWidth, atlasHeight);
-	Bitmap<FloatRGB> atlas(atlasWidth, atlasHeight);
-	WriteGlyphsToAtlas(glyphs, width, atlas);
-	SerializeGlyphs(glyphs,width, atlasWidth, atlasHeight, output);
-	saveMaterial(output);
-	saveTexture(output);
+	}
+
+	// Try frames from a quarter of the size up in steps of an eighth, with the reference at twice the full resolution.
+	// The glyphs are searched in parallel, each by a task that only modifies the glyph and copies of its shape
+	if (adaptiveError > 0 && mode != METRICS) {
+		settings.invert = orientation == REVERSE && legacyMode;
+		std::vector<Glyph *> schedule;
+		for (auto& g : glyphs) {
+			if (g.width && g.height)
+				schedule.push_back(&g);
+		}
+		// Longest estimated search first
+		std::stable_sort(schedule.begin(), schedule.end(), [&](const Glyph *a, const Glyph *b) {
+			return estimateGlyphCost(*a) > estimateGlyphCost(*b);
+		});
+		std::atomic<int> nextGlyph(0);
+		FunctionJob job([&](int) {
+			Glyph &g = *schedule[nextGlyph++];
+			const GlyphFrame &frame = frames[&g-&glyphs[0]];
+			for (int eighths = 2; eighths < 8; ++eighths) {
+				int size = max(width*eighths/8, 1);
+				frameCell(g, frame, (double) size/width);
+				if (!g.width || !g.height)
+					continue;
+				double factor = (double) width/size;
+				Glyph candidate = g;
+				finishShape(candidate.shape, candidate.scale);
+				if (measureGlyphError(candidate, settings, (int) ceil(2*factor*g.width), (int) ceil(2*factor*g.height)) <= 2*adaptiveError) {
+					g.size = size;
+					break;
+				}
+			}
+			if (g.size == width)
+				frameCell(g, frame, 1);
+		});
+		ThreadPool::shared().run(job, schedule.size());
+	}
+
+	for (auto& g : glyphs) {
+		g.xoffset = -g.translate.x;
+		g.yoffset = g.translate.y;
+	}
+
+	if (printMetrics) {
+		for (auto& g : glyphs) {
+			double l = LARGE_VALUE, b = LARGE_VALUE, r = -LARGE_VALUE, t = -LARGE_VALUE;
+			g.shape.bounds(l, b, r, t);
+			printf("glyph %d:", g.code);
+			if (l < r && b < t)
+				printf(" bounds = %.12g, %.12g, %.12g, %.12g;", l, b, r, t);
+			printf(" advance = %.12g; scale = %.12g, %.12g; translate = %.12g, %.12g; range = %.12g; cell = %d x %d", g.advance, g.scale.x, g.scale.y, g.translate.x, g.translate.y, g.range, g.width, g.height);
+			if (g.size != width)
+				printf("; frame = %d", g.size);
+			printf("\n");
+		}
+	}
+
+	if (kernelCheck) {
+		const EdgeKernels *kernelSets[] = { edgeKernelsSSE2(), edgeKernelsAVX2(), edgeKernelsSSEFloat() };
+		for (const EdgeKernels *kernels : kernelSets) {
+			if (!kernels)
+				continue;
+			double deviation = 0, pseudoDeviation = 0;
+			for (auto& g : glyphs) {
+				double glyphPseudoDeviation;
+				deviation = max(deviation, measureKernelDeviation(*kernels, g.shape, g.range, g.scale, g.translate, g.width, g.height, &glyphPseudoDeviation));
+				pseudoDeviation = max(pseudoDeviation, glyphPseudoDeviation);
+			}
+			printf("%s kernels: maximum deviation %g px, pseudo-distance %g px\n", kernels->name, deviation, pseudoDeviation);
+		}
+	}
+
+	// With a memory budget, only the glyphs of the band being generated are kept in memory, the rest are reloaded from the font
+	bool reloadShapes = memoryBudget && font;
+	if (reloadShapes) {
+		for (auto& g : glyphs)
+			g.shape = Shape();
+	}
+
+	// Pack the glyphs first, so that their distance fields can be generated directly into the atlas
+	std::vector<AtlasPage> pages;
+	if (!PackGlyphs(glyphs, maxPageSize, pages))
+		ABORT("The cell of a glyph exceeds the maximum page size.");
+	if (pages.size() > 1 && !output)
+		ABORT("An atlas of multiple pages cannot be written to the standard output.");
+	std::vector<std::string> pageOutputs;
+	for (size_t p = 0; p < pages.size(); ++p)
+		pageOutputs.push_back(pages.size() > 1 ? pageFileName(output, p) : std::string());
+	auto pageOutput = [&](int p) -> const char * {
+		return pages.size() > 1 ? pageOutputs[p].c_str() : output;
+	};
+
+	// Formats with 8 bits per channel get an 8-bit atlas, unless the legacy distance fields are inverted,
+	// which must happen before quantization to round the same way
+	if (format == AUTO && output) {
+		format = deduceFormat(output);
+		if (format == AUTO)
+			ABORT("Could not deduce format from output file name.");
+	}
+	bool invertLegacy = orientation == REVERSE && legacyMode;
+	bool byteAtlas = format != TEXT_FLOAT && format != BINARY_FLOAT && format != BINART_FLOAT_BE && !invertLegacy;
+	size_t channelSize = byteAtlas ? sizeof(unsigned char) : sizeof(float);
+	size_t pixelSize = (mode == MULTI_AND_TRUE ? 4 : mode == MULTI ? 3 : 1)*channelSize;
+
+	settings.invert = invertLegacy;
+
+	// Each page of the atlas is generated in horizontal bands of rows, each containing the glyphs whose top row lies in it.
+	// The buffer extends below the band by the height of the tallest cell, so that these glyphs fit in it entirely,
+	// and the extra rows are carried over to the next band. Without a memory budget, a single band covers the whole page.
+	int cellHeight = 0;
+	for (auto& g : glyphs)
+		cellHeight = max(cellHeight, g.height);
+	std::vector<std::unique_ptr<AtlasBand> > bands(pages.size());
+
+	// Generates the distance fields of the glyphs in parallel, where y0 is the row of their pages at the top of their bands.
+	// Returns false if a glyph fails to reload.
+	auto generateGlyphs = [&](std::vector<Glyph *> &schedule, int y0) -> bool {
+		if (reloadShapes) {
+			for (Glyph *g : schedule) {
+				if (!loadGlyph(g->shape, font, g->code) || !prepareShape(g->shape))
+					return false;
+			}
+		}
+
+		// Longest estimated job first
+		std::stable_sort(schedule.begin(), schedule.end(), [&](const Glyph *a, const Glyph *b) {
+			return estimateGlyphCost(*a) > estimateGlyphCost(*b);
+		});
+		std::atomic<int> nextGlyph(0);
+		FunctionJob job([&](int) {
+			// Tasks may start in any order, so each one takes the most expensive glyph left
+			Glyph &g = *schedule[nextGlyph++];
+			finishShape(g.shape, g.scale);
+			std::string cacheFile;
+			if (cacheDirectory) {
+				cacheFile = glyphCacheFile(cacheDirectory, g, settings, pixelSize);
+				if (FILE *file = fopen(cacheFile.c_str(), "rb")) {
+					bool cached = bands[g.page]->readGlyph(file, g, y0);
+					fclose(file);
+					if (cached)
+						return;
+				}
+			}
+			// The glyphs occupy disjoint regions of the atlas, which are therefore written concurrently
+			bands[g.page]->generateGlyph(g, y0, settings);
+			if (cacheDirectory) {
+				// The file is written under a name unique to this process and glyph and then renamed,
+				// so that it is never read incomplete, even by other builds that share the cache
+				std::string partFile = cacheFile+"."+std::to_string(getpid())+"."+std::to_string(&g-&glyphs[0])+".part";
+				if (FILE *file = fopen(partFile.c_str(), "wb")) {
+					bool written = bands[g.page]->writeGlyph(file, g, y0);
+					if (fclose(file) || !written || rename(partFile.c_str(), cacheFile.c_str()))
+						remove(partFile.c_str());
+				}
+			}
+		});
+		ThreadPool::shared().run(job, schedule.size());
+
+		if (reloadShapes) {
+			for (Glyph *g : schedule)
+				g->shape = Shape();
+		}
+		return true;
+	};
+
+	// Glyphs without a cell, such as the space, have no distance field and are not scheduled
+	bool outputFailed = false;
+	if (memoryBudget) {
+		// The pages are streamed one after another
+		for (int p = 0; p < (int) pages.size(); ++p) {
+			const AtlasPage &page = pages[p];
+			// The buffer holds the band and the tallest cell below it, in rows of the padded stride
+			unsigned long long budgetRows = memoryBudget/max(atlasRowSize(mode, byteAtlas, page.width), (size_t) 1);
+			if (budgetRows <= (unsigned long long) cellHeight)
+				ABORT("The memory budget cannot hold a band of the atlas. Increase -membudget.");
+			int bandHeight = int(min(budgetRows, (unsigned long long) page.height+cellHeight))-cellHeight;
+			bands[p].reset(createAtlasBand(mode, byteAtlas, page.width, bandHeight+cellHeight));
+			if (!bands[p])
+				break;
+			FILE *outputFile = NULL;
+			if (const char *error = bands[p]->beginOutput(outputFile, pageOutput(p), format, page.height))
+				ABORT(error);
+
+			std::vector<Glyph *> glyphsByRow;
+			for (auto& g : glyphs) {
+				if (g.page == p && g.width && g.height)
+					glyphsByRow.push_back(&g);
+			}
+			std::stable_sort(glyphsByRow.begin(), glyphsByRow.end(), [&](const Glyph *a, const Glyph *b) {
+				return a->y < b->y;
+			});
+			std::vector<Glyph *>::const_iterator nextInBand = glyphsByRow.begin();
+			for (int y0 = 0; y0 < page.height; y0 += bandHeight) {
+				std::vector<Glyph *> schedule;
+				for (; nextInBand != glyphsByRow.end() && (*nextInBand)->y < y0+bandHeight; ++nextInBand)
+					schedule.push_back(*nextInBand);
+				if (!generateGlyphs(schedule, y0))
+					ABORT("Failed to reload glyph from font file.");
+				outputFailed |= !bands[p]->flush(outputFile, format, min(bandHeight, page.height-y0));
+			}
+			if (outputFile && outputFile != stdout && fclose(outputFile))
+				outputFailed = true;
+			bands[p].reset();
+		}
+	} else {
+		// All pages are generated at once
+		std::vector<Glyph *> schedule;
+		for (auto& g : glyphs) {
+			if (g.width && g.height)
+				schedule.push_back(&g);
+		}
+		for (size_t p = 0; p < pages.size(); ++p)
+			bands[p].reset(createAtlasBand(mode, byteAtlas, pages[p].width, pages[p].height));
+		if (bands[0] && !generateGlyphs(schedule, 0))
+			ABORT("Failed to reload glyph from font file.");
+	}
+	if (font) {
+		destroyFont(font);
+		deinitializeFreetype(ft);
+	}
+
+	SerializeGlyphs(glyphs, width, pages, output);
+	for (size_t p = 0; p < pages.size(); ++p) {
+		saveMaterial(pageOutput(p));
+		saveTexture(pageOutput(p));
+	}
 	const char *error = NULL;
-	switch (mode) {
-	    case MULTI:
-	        error = writeOutput(atlas, output, format);
-	        if (error)
-	            ABORT(error);
-	        break;
-	    default:
-	        break;
+	if (memoryBudget) {
+		if (outputFailed)
+			error = "Failed to write output file.";
+	} else if (bands[0]) {
+		// The pages are written in parallel
+		std::vector<const char *> errors(pages.size());
+		FunctionJob job([&](int p) {
+			errors[p] = bands[p]->write(pageOutput(p), format);
+		});
+		ThreadPool::shared().run(job, pages.size());
+		for (const char *pageError : errors) {
+			if (pageError)
+				error = pageError;
+		}
 	}
+	if (error)
+	    ABORT(error);
 
 	
     // Save output
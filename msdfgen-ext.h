@@ -24,3 +24,4 @@
 #include "ext/save-dds.h"
 #include "ext/json.hpp"
 #include "ext/save_material.h"
+#include "ext/DynamicAtlas.h"
@@ -19,6 +19,12 @@
 #include "core/Vector2.h"
 #include "core/Shape.h"
 #include "core/Bitmap.h"
+#include "core/BitmapRef.h"
+#include "core/BitmapPool.h"
+#include "core/pixel-conversion.hpp"
+#include "core/Scanline.h"
+#include "core/PreparedShape.h"
+#include "core/ThreadPool.h"
 #include "core/edge-coloring.h"
 #include "core/render-sdf.h"
 #include "core/save-bmp.h"
@@ -28,18 +34,99 @@
 
 namespace msdfgen {
 
+/** The generators below determine the sign of each pixel from the winding number of the shape along its row of pixels,
+ *  which is interpreted according to fillRule. Overlapping and self-intersecting contours are therefore supported.
+ *  If skipSaturated is enabled, they fill regions that are provably farther than half the range from the shape
+ *  with 0 or 1 instead of evaluating their distances. The result is identical after quantization to 8 bits per channel,
+ *  but distances beyond the range are not preserved in floating-point output.
+ *  All generators write through a BitmapRef, so they can fill a region of a larger bitmap, such as an atlas, directly.
+ */
+
 /// Generates a conventional single-channel signed distance field.
-void generateSDF(Bitmap<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generateSDF(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
 
 /// Generates a single-channel signed pseudo-distance field.
-void generatePseudoSDF(Bitmap<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generatePseudoSDF(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
 
 /// Generates a multi-channel signed distance field. Edge colors must be assigned first! (see edgeColoringSimple)
-void generateMSDF(Bitmap<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateMSDF(const BitmapRef<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+
+/// Generates a multi-channel signed distance field with the true signed distance in the alpha channel in a single pass.
+/// Edge colors must be assigned first! (see edgeColoringSimple)
+void generateMTSDF(const BitmapRef<FloatRGBA> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+
+/// Sets the number of threads used by the distance field generators. Zero (default) selects one per hardware thread.
+/// The generated distance fields are identical regardless of the number of threads.
+void setThreadCount(int threadCount);
+
+/** Returns the maximum difference in pixels between the signed distances computed by the batched kernels and by the
+ *  double-precision scalar path for the pixels of a width x height distance field of the shape closer than half the range
+ *  to each edge. Zero for the double-precision kernels; use it to assess the single-precision kernels on a set of shapes.
+ *  If pseudoDeviation is not NULL, it receives the maximum difference of the pseudo-distances derived from the distances
+ *  and their edge parameters, which may be larger, since a deviating parameter can select the extension of the edge.
+ */
+double measureKernelDeviation(const EdgeKernels &kernels, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, int width, int height, double *pseudoDeviation = NULL);
 
 // Original simpler versions of the previous functions, which work well under normal circumstances, but cannot deal with overlapping contours.
-void generateSDF_legacy(Bitmap<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
-void generatePseudoSDF_legacy(Bitmap<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
-void generateMSDF_legacy(Bitmap<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateSDF_legacy(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generatePseudoSDF_legacy(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generateMSDF_legacy(const BitmapRef<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateMTSDF_legacy(const BitmapRef<FloatRGBA> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+
+/** Edge-major versions of generateSDF, generatePseudoSDF, generateMSDF and generateMTSDF, which only evaluate each edge
+ *  in the band of pixels closer to it than half the range, so that their cost grows with the length of the outline rather than the area of the output.
+ *  Pixels farther than half the range from all edges (of the respective channel) are saturated to 0 or 1.
+ */
+void generateSDF_edgeMajor(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void generatePseudoSDF_edgeMajor(const BitmapRef<float> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void generateMSDF_edgeMajor(const BitmapRef<FloatRGB> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, FillRule fillRule = FILL_NONZERO);
+void generateMTSDF_edgeMajor(const BitmapRef<FloatRGBA> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, FillRule fillRule = FILL_NONZERO);
+
+/** Versions of all of the above generators that take a prepared shape (see PreparedShape) instead.
+ *  The per-edge precomputation is then only performed once when several distance fields are generated from the same shape.
+ */
+void generateSDF(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generatePseudoSDF(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateMSDF(const BitmapRef<FloatRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateMTSDF(const BitmapRef<FloatRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateSDF_legacy(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generatePseudoSDF_legacy(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generateMSDF_legacy(const BitmapRef<FloatRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateMTSDF_legacy(const BitmapRef<FloatRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateSDF_edgeMajor(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void generatePseudoSDF_edgeMajor(const BitmapRef<float> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void generateMSDF_edgeMajor(const BitmapRef<FloatRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, FillRule fillRule = FILL_NONZERO);
+void generateMTSDF_edgeMajor(const BitmapRef<FloatRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, FillRule fillRule = FILL_NONZERO);
+
+/** Versions of the generators with prepared shapes that store the distance field in compact pixel types as it is generated:
+ *  8-bit channels, quantized exactly like the image writers quantize floating-point bitmaps, or half-precision floats.
+ *  The (pseudo) SDF generators support unsigned char and Half, MSDF ByteRGB and HalfRGB, and MTSDF ByteRGBA and HalfRGBA.
+ *  Because the clash test requires the floating-point distances, the multi-channel generators with error correction enabled
+ *  use a temporary floating-point bitmap of the size of the output, whose storage is recycled through BitmapPool::shared.
+ */
+void generateSDF(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateSDF(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generatePseudoSDF(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generatePseudoSDF(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateMSDF(const BitmapRef<ByteRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateMSDF(const BitmapRef<HalfRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateMTSDF(const BitmapRef<ByteRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateMTSDF(const BitmapRef<HalfRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, bool skipSaturated = false, FillRule fillRule = FILL_NONZERO);
+void generateSDF_legacy(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generateSDF_legacy(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generatePseudoSDF_legacy(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generatePseudoSDF_legacy(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate);
+void generateMSDF_legacy(const BitmapRef<ByteRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateMSDF_legacy(const BitmapRef<HalfRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateMTSDF_legacy(const BitmapRef<ByteRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateMTSDF_legacy(const BitmapRef<HalfRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001);
+void generateSDF_edgeMajor(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void generateSDF_edgeMajor(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void generatePseudoSDF_edgeMajor(const BitmapRef<unsigned char> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void generatePseudoSDF_edgeMajor(const BitmapRef<Half> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, FillRule fillRule = FILL_NONZERO);
+void generateMSDF_edgeMajor(const BitmapRef<ByteRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, FillRule fillRule = FILL_NONZERO);
+void generateMSDF_edgeMajor(const BitmapRef<HalfRGB> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, FillRule fillRule = FILL_NONZERO);
+void generateMTSDF_edgeMajor(const BitmapRef<ByteRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, FillRule fillRule = FILL_NONZERO);
+void generateMTSDF_edgeMajor(const BitmapRef<HalfRGBA> &output, const PreparedShape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = 1.00000001, FillRule fillRule = FILL_NONZERO);
 
 }